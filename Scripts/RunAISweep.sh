@@ -0,0 +1,66 @@
+#!/usr/bin/env bash
+# Runs every row of a guard tuning CSV as its own headless, fast-forward simulation (see UFPSSimulationSubsystem),
+# as many at once as there are cores, & merges the results into one CSV.
+#
+# Usage: Scripts/RunAISweep.sh <PackagedDir> <Params.csv> [DurationSeconds] [Jobs] [BotScript]
+#   PackagedDir  Folder with the packaged Linux game, e.g. Packaged/Linux
+#   Params.csv   Header of UFPSGuardConfig property names, then one row of values per run, e.g.
+#                  HearingThreshold,ResetOrientationDelay,SightRadius
+#                  1200,3.0,4000
+#   Duration     Game seconds before a run counts as a timeout (default 600)
+#   Jobs         Runs at the same time (default: number of cores)
+#   BotScript    Optional bot script for the player, otherwise it random walks. Run N always uses seed N.
+
+set -euo pipefail
+
+PACKAGED_DIR="${1:?Usage: $0 <PackagedDir> <Params.csv> [DurationSeconds] [Jobs] [BotScript]}"
+PARAMS="$(realpath "${2:?Usage: $0 <PackagedDir> <Params.csv> [DurationSeconds] [Jobs] [BotScript]}")"
+DURATION="${3:-600}"
+JOBS="${4:-$(nproc)}"
+BOT_SCRIPT="${5:-}"
+
+GAME_BIN="${PACKAGED_DIR}/FPSGame/Binaries/Linux/FPSGame"
+OUT_DIR="$(pwd)/Sweep_$(date +%Y%m%d_%H%M%S)"
+mkdir -p "${OUT_DIR}"
+
+# Same rule as the simulation uses to number rows: blank lines & comments don't count
+NUM_RUNS=$(( $(grep -cv -e '^[[:space:]]*$' -e '^#' "${PARAMS}") - 1 ))
+if (( NUM_RUNS <= 0 )); then
+	echo "${PARAMS} has no parameter rows" >&2
+	exit 1
+fi
+
+BOT_ARG=""
+if [[ -n "${BOT_SCRIPT}" ]]; then
+	BOT_ARG="-FPSBotScript=$(realpath "${BOT_SCRIPT}")"
+fi
+
+export GAME_BIN PARAMS DURATION OUT_DIR BOT_ARG
+run_one() {
+	local i="$1"
+	# No rendering & no audio, the runs only need the game thread
+	"${GAME_BIN}" -FPSSim -FPSSimParams="${PARAMS}" -FPSSimIndex="${i}" -FPSSimDuration="${DURATION}" \
+		-FPSSimOut="${OUT_DIR}/Run_${i}.csv" -FPSBot -FPSBotSeed="${i}" ${BOT_ARG} \
+		-nullrhi -nosound -nosplash -unattended -log="Sim_${i}.log" >/dev/null 2>&1 \
+		|| echo "Run ${i} exited with an error, see Saved/Logs/Sim_${i}.log" >&2
+}
+export -f run_one
+
+echo "Running ${NUM_RUNS} simulations, ${JOBS} at a time"
+seq 0 $(( NUM_RUNS - 1 )) | xargs -P "${JOBS}" -I{} bash -c 'run_one {}'
+
+# Every run wrote its own header & row, keep the first header only
+RESULTS="${OUT_DIR}/Results.csv"
+FIRST=1
+for ((i = 0; i < NUM_RUNS; i++)); do
+	f="${OUT_DIR}/Run_${i}.csv"
+	[[ -f "${f}" ]] || continue
+	if (( FIRST )); then
+		cat "${f}" > "${RESULTS}"
+		FIRST=0
+	else
+		tail -n +2 "${f}" >> "${RESULTS}"
+	fi
+done
+
+echo "Results written to ${RESULTS}"
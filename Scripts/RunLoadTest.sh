@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+# Starts a dedicated server & a number of headless bot clients on this machine, connected over loopback.
+# The server writes its stats to Saved/LoadTest/ (see UFPSLoadTestSubsystem), each bot logs to Saved/Logs/.
+#
+# Usage: Scripts/RunLoadTest.sh <PackagedDir> [NumBots] [DurationSeconds] [BotScript]
+#   PackagedDir  Folder with the packaged Linux server & client, e.g. Packaged/LinuxServer & Packaged/Linux side by side
+#   NumBots      Bot clients to start (default 16)
+#   Duration     Seconds to run before everything is stopped (default 300)
+#   BotScript    Optional bot script file, otherwise the bots random walk
+
+set -euo pipefail
+
+PACKAGED_DIR="${1:?Usage: $0 <PackagedDir> [NumBots] [DurationSeconds] [BotScript]}"
+NUM_BOTS="${2:-16}"
+DURATION="${3:-300}"
+BOT_SCRIPT="${4:-}"
+
+SERVER_BIN="${PACKAGED_DIR}/LinuxServer/FPSGame/Binaries/Linux/FPSGameServer"
+CLIENT_BIN="${PACKAGED_DIR}/Linux/FPSGame/Binaries/Linux/FPSGame"
+PORT=7777
+
+PIDS=()
+cleanup() {
+	kill "${PIDS[@]}" 2>/dev/null || true
+	wait 2>/dev/null || true
+}
+trap cleanup EXIT INT TERM
+
+"${SERVER_BIN}" -log=LoadTestServer.log -port=${PORT} -FPSLoadTest -unattended &
+PIDS+=($!)
+
+# Give the server time to load the map before the first client connects
+sleep 10
+
+BOT_ARGS=()
+if [[ -n "${BOT_SCRIPT}" ]]; then
+	BOT_ARGS+=("-FPSBotScript=${BOT_SCRIPT}")
+fi
+
+# No rendering & no audio keeps each bot to a fraction of a normal client's memory & CPU
+for ((i = 0; i < NUM_BOTS; i++)); do
+	"${CLIENT_BIN}" 127.0.0.1:${PORT} -nullrhi -nosound -unattended -FPSBot -FPSBotSeed=${i} ${BOT_ARGS[@]+"${BOT_ARGS[@]}"} \
+		-log=LoadTestBot_${i}.log >/dev/null 2>&1 &
+	PIDS+=($!)
+done
+
+echo "Running ${NUM_BOTS} bots for ${DURATION} seconds"
+sleep "${DURATION}"
@@ -3,11 +3,22 @@
 
 #include "FPSAICharacter.h"
 #include "Perception/PawnSensingComponent.h"
+#include "FPSPatrolRouteComponent.h"
+#include "FPSGuardConfig.h"
+#include "FPSAlertSubsystem.h"
+#include "FPSSimulationSubsystem.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "SignificanceManager.h"
+#include "Engine/World.h"
 #include "DrawDebugHelpers.h"
 #include "FPSGameMode.h"
 /*This allows us to use the GetLifetimeReplicatedProps fn*/
 #include "Net/UnrealNetwork.h"
 
+static const FName GuardSignificanceTag(TEXT("Guard"));
+
 // Sets default values
 AFPSAICharacter::AFPSAICharacter()
 {
@@ -20,7 +31,18 @@ AFPSAICharacter::AFPSAICharacter()
 	PawnSensingComp->OnSeePawn.AddDynamic(this, &AFPSAICharacter::OnSeenPawn);
 	PawnSensingComp->OnHearNoise.AddDynamic(this, &AFPSAICharacter::OnNoiseHeard);
 
+	PatrolRouteComp = CreateDefaultSubobject<UFPSPatrolRouteComponent>(TEXT("PatrolRouteComp"));
+
+	/* Patrolling guards should face the way they walk. SetActorRotation in OnNoiseHeard still works as before
+	* because the guard is stopped while it's looking at the noise. */
+	bUseControllerRotationYaw = false;
+	GetCharacterMovement()->bOrientRotationToMovement = true;
+
+	// Lets the engine skip anim updates on guards that are small on screen. The significance code below handles off-screen guards.
+	GetMesh()->bEnableUpdateRateOptimizations = true;
+
 	GuardState = EAIState::Idle;
+	bFacingPlayer = false;
 }
 
 // Called when the game starts or when spawned
@@ -29,6 +51,223 @@ void AFPSAICharacter::BeginPlay()
 	Super::BeginPlay();
 	
 	OriginalRotation = GetActorRotation();
+
+	/* Clients & the server both pay for animating & moving every guard, so both register with the significance manager.
+	* UFPSSignificanceSubsystem feeds it the players' viewpoints every frame. */
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld());
+	if (SignificanceManager && GetGuardConfig()->bScaleBySignificance)
+	{
+		SignificanceManager->RegisterObject(this, GuardSignificanceTag,
+			[](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint)
+			{
+				return CastChecked<AFPSAICharacter>(ObjectInfo->GetObject())->CalculateSignificance(Viewpoint);
+			},
+			USignificanceManager::EPostSignificanceType::Sequential,
+			[](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float NewSignificance, bool bFinal)
+			{
+				// bFinal is the call made while the guard unregisters in EndPlay, there's nothing left to scale by then
+				if (bFinal)
+				{
+					return;
+				}
+
+				// With no viewpoints at all (e.g. a server nobody has joined yet) the manager hands us the lowest float there is
+				const float Significance = FMath::Clamp(NewSignificance, (float)EGuardSignificance::Minimal, (float)EGuardSignificance::Full);
+				CastChecked<AFPSAICharacter>(ObjectInfo->GetObject())->ApplySignificance((EGuardSignificance)FMath::RoundToInt(Significance));
+			});
+	}
+
+	if (!HasAuthority())
+	{
+		/* Sensing & patrolling only ever run on the server. On clients these components are dead weight on every guard,
+		* so we get rid of them. Everything that uses them is only reached on the server. */
+		PawnSensingComp->DestroyComponent();
+		PawnSensingComp = nullptr;
+		PatrolRouteComp->DestroyComponent();
+		PatrolRouteComp = nullptr;
+		return;
+	}
+
+	ApplyGuardConfig();
+
+	/* Most guards stand at a post. Their route component would only ever hold an empty waypoint list,
+	* so the server frees it as well & every guard without a route is one component smaller. */
+	if (PatrolRouteComp->HasRoute())
+	{
+		PatrolRouteComp->StartPatrol();
+	}
+	else
+	{
+		PatrolRouteComp->DestroyComponent();
+		PatrolRouteComp = nullptr;
+	}
+
+	UpdateNetSettings(GuardState);
+
+	// Every guard starts at a random point in the interval so a level full of guards doesn't check on the same frame
+	const float FacingCheckInterval = GetGuardConfig()->FacingCheckInterval;
+	if (FacingCheckInterval > 0.0f)
+	{
+		GetWorldTimerManager().SetTimer(TimerHandle_FacingCheck, this, &AFPSAICharacter::UpdateFacingPlayer, FacingCheckInterval, true, FMath::FRand() * FacingCheckInterval);
+	}
+
+	if (UFPSAlertSubsystem* AlertSubsystem = GetWorld()->GetSubsystem<UFPSAlertSubsystem>())
+	{
+		AlertSubsystem->RegisterGuard(this);
+	}
+}
+
+void AFPSAICharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld()))
+	{
+		SignificanceManager->UnregisterObject(this);
+	}
+
+	if (UFPSAlertSubsystem* AlertSubsystem = GetWorld()->GetSubsystem<UFPSAlertSubsystem>())
+	{
+		AlertSubsystem->UnregisterGuard(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool AFPSAICharacter::HasPatrolRoute() const
+{
+	return PatrolRouteComp && PatrolRouteComp->HasRoute();
+}
+
+const UFPSGuardConfig* AFPSAICharacter::GetGuardConfig() const
+{
+	return GuardConfig ? GuardConfig : GetDefault<UFPSGuardConfig>();
+}
+
+void AFPSAICharacter::ApplyGuardConfig()
+{
+	/* Without an asset we leave the component alone so values set on the BP's PawnSensingComp still work.
+	* A simulation run applies only the values it's sweeping, the rest stays as the BP set it up. */
+	const UFPSSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UFPSSimulationSubsystem>();
+	auto ShouldApply = [this, Simulation](FName ConfigProperty)
+	{
+		return GuardConfig != nullptr || (Simulation && Simulation->IsSweepingProperty(ConfigProperty));
+	};
+
+	const UFPSGuardConfig* Config = GetGuardConfig();
+	if (ShouldApply(GET_MEMBER_NAME_CHECKED(UFPSGuardConfig, SightRadius)))
+	{
+		PawnSensingComp->SightRadius = Config->SightRadius;
+	}
+	if (ShouldApply(GET_MEMBER_NAME_CHECKED(UFPSGuardConfig, PeripheralVisionAngle)))
+	{
+		PawnSensingComp->SetPeripheralVisionAngle(Config->PeripheralVisionAngle);
+	}
+	if (ShouldApply(GET_MEMBER_NAME_CHECKED(UFPSGuardConfig, HearingThreshold)))
+	{
+		PawnSensingComp->HearingThreshold = Config->HearingThreshold;
+	}
+	if (ShouldApply(GET_MEMBER_NAME_CHECKED(UFPSGuardConfig, LOSHearingThreshold)))
+	{
+		PawnSensingComp->LOSHearingThreshold = Config->LOSHearingThreshold;
+	}
+	if (ShouldApply(GET_MEMBER_NAME_CHECKED(UFPSGuardConfig, SensingInterval)))
+	{
+		PawnSensingComp->SetSensingInterval(Config->SensingInterval);
+	}
+}
+
+/* This can run on worker threads so it must only read state.
+* Close guards stay at full detail even behind the player since the player could turn around at any moment. */
+float AFPSAICharacter::CalculateSignificance(const FTransform& Viewpoint) const
+{
+	// A guard that's investigating or has seen someone is what the player is paying attention to
+	if (GuardState != EAIState::Idle)
+	{
+		return (float)EGuardSignificance::Full;
+	}
+
+	const UFPSGuardConfig* Config = GetGuardConfig();
+	const FVector ToGuard = GetActorLocation() - Viewpoint.GetLocation();
+	const float DistanceSquared = ToGuard.SizeSquared();
+	if (DistanceSquared <= FMath::Square(Config->FullDetailDistance))
+	{
+		return (float)EGuardSignificance::Full;
+	}
+
+	const float ViewDot = FVector::DotProduct(Viewpoint.GetRotation().GetForwardVector(), ToGuard.GetSafeNormal());
+	const bool bInView = ViewDot >= FMath::Cos(FMath::DegreesToRadians(Config->ViewConeHalfAngle));
+	if (DistanceSquared <= FMath::Square(Config->ReducedDetailDistance))
+	{
+		return (float)(bInView ? EGuardSignificance::Full : EGuardSignificance::Reduced);
+	}
+	return (float)(bInView ? EGuardSignificance::Reduced : EGuardSignificance::Minimal);
+}
+
+void AFPSAICharacter::ApplySignificance(EGuardSignificance Significance)
+{
+	/* The manager calls us on every update, not only when the level changes. Setting tick intervals & suspending cloth
+	* every frame for every guard is the cost we're trying to get rid of, so only a change of level does anything. */
+	if (AppliedSignificance.IsSet() && AppliedSignificance.GetValue() == Significance)
+	{
+		return;
+	}
+	AppliedSignificance = Significance;
+
+	const UFPSGuardConfig* Config = GetGuardConfig();
+	USkeletalMeshComponent* MeshComp = GetMesh();
+	UCharacterMovementComponent* MovementComp = GetCharacterMovement();
+
+	// We go back to whatever the class (or its BP) set up, rather than to hard coded values
+	const AFPSAICharacter* DefaultGuard = GetClass()->GetDefaultObject<AFPSAICharacter>();
+	const USkeletalMeshComponent* DefaultMesh = DefaultGuard->GetMesh();
+
+	switch (Significance)
+	{
+	case EGuardSignificance::Full:
+		MeshComp->SetComponentTickInterval(DefaultMesh->PrimaryComponentTick.TickInterval);
+		MeshComp->VisibilityBasedAnimTickOption = DefaultMesh->VisibilityBasedAnimTickOption;
+		MeshComp->KinematicBonesUpdateToPhysics = DefaultMesh->KinematicBonesUpdateToPhysics;
+		MeshComp->ResumeClothingSimulation();
+		MovementComp->SetComponentTickEnabled(true);
+		MovementComp->SetComponentTickInterval(DefaultGuard->GetCharacterMovement()->PrimaryComponentTick.TickInterval);
+		break;
+
+	case EGuardSignificance::Reduced:
+		MeshComp->SetComponentTickInterval(Config->ReducedTickInterval);
+		MeshComp->VisibilityBasedAnimTickOption = DefaultMesh->VisibilityBasedAnimTickOption;
+		MeshComp->KinematicBonesUpdateToPhysics = DefaultMesh->KinematicBonesUpdateToPhysics;
+		MeshComp->ResumeClothingSimulation();
+		MovementComp->SetComponentTickEnabled(true);
+		MovementComp->SetComponentTickInterval(Config->ReducedTickInterval);
+		break;
+
+	case EGuardSignificance::Minimal:
+		// Nobody can see the pose, & nothing simulates against the bodies of a guard that is this far away
+		MeshComp->SetComponentTickInterval(Config->MinimalTickInterval);
+		MeshComp->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+		MeshComp->KinematicBonesUpdateToPhysics = EKinematicBonesUpdateToPhysics::SkipAllBones;
+		MeshComp->SuspendClothingSimulation();
+
+		/* A server guard without a route never moves on its own, so its movement doesn't need to tick at all.
+		* It's turned back on as soon as it gets Suspicious. */
+		if (HasAuthority() && !HasPatrolRoute())
+		{
+			MovementComp->SetComponentTickEnabled(false);
+		}
+		else if (HasAuthority())
+		{
+			/* Server movement is the real one. Big steps would overshoot waypoints & path corners, & how far would depend on
+			* where the players are standing, so a walking guard never steps coarser than at Reduced detail. */
+			MovementComp->SetComponentTickEnabled(true);
+			MovementComp->SetComponentTickInterval(FMath::Min(Config->ReducedTickInterval, Config->MinimalTickInterval));
+		}
+		else
+		{
+			// Clients only smooth the replicated movement, nobody sees how smooth it is this far away
+			MovementComp->SetComponentTickEnabled(true);
+			MovementComp->SetComponentTickInterval(Config->MinimalTickInterval);
+		}
+		break;
+	}
 }
 
 // Called every frame
@@ -40,16 +279,30 @@ void AFPSAICharacter::Tick(float DeltaTime)
 
 void AFPSAICharacter::OnSeenPawn(APawn* SeenPawn)
 {
-	if (SeenPawn == nullptr)
+	AFPSGameMode* GM = Cast<AFPSGameMode>(GetWorld()->GetAuthGameMode());
+	if (SeenPawn == nullptr || (GM && !GM->AreInSameMatch(this, SeenPawn)))
 	{
 		return;
 	}
 
-	DrawDebugSphere(GetWorld(), SeenPawn->GetActorLocation(), 32.0f, 8, FColor::Yellow, false, 10.0f);
+	const UFPSGuardConfig* Config = GetGuardConfig();
+	if (Config->bDrawDebugSpheres)
+	{
+		DrawDebugSphere(GetWorld(), SeenPawn->GetActorLocation(), 32.0f, 8, FColor::Yellow, false, Config->DebugSphereDuration);
+	}
 
 	ChangeGuardState(EAIState::Alerted);
+	if (PatrolRouteComp)
+	{
+		PatrolRouteComp->PausePatrol();
+	}
+
+	// The guards around us turn to look too. The subsystem passes it on through squad leaders so this stays cheap with hundreds of guards.
+	if (UFPSAlertSubsystem* AlertSubsystem = GetWorld()->GetSubsystem<UFPSAlertSubsystem>())
+	{
+		AlertSubsystem->RaiseAlert(this, SeenPawn->GetActorLocation());
+	}
 
-	AFPSGameMode* GM = Cast<AFPSGameMode>(GetWorld()->GetAuthGameMode());
 	if (GM)
 	{
 		GM->CompleteMission(SeenPawn, false);
@@ -61,8 +314,33 @@ void AFPSAICharacter::OnNoiseHeard(APawn* NoiseInstigator, const FVector& Locati
 	// If the guard can aldready see player, you can't distract him with sound
 	// Alerted state has higher priority over any other state
 	if (GuardState == EAIState::Alerted) { return; }
-	DrawDebugSphere(GetWorld(), Location, 32.0f, 8, FColor::Green, false, 10.0f);
-	
+	const UFPSGuardConfig* Config = GetGuardConfig();
+	if (Config->bDrawDebugSpheres)
+	{
+		DrawDebugSphere(GetWorld(), Location, 32.0f, 8, FColor::Green, false, Config->DebugSphereDuration);
+	}
+
+	InvestigateLocation(Location);
+}
+
+void AFPSAICharacter::ReceiveAlert(const FVector& Location)
+{
+	// A guard that can see the intruder itself doesn't need to be told where to look
+	if (GuardState == EAIState::Alerted) { return; }
+
+	InvestigateLocation(Location);
+}
+
+void AFPSAICharacter::InvestigateLocation(const FVector& Location)
+{
+	// Stop walking the route so the guard can turn towards the location
+	if (PatrolRouteComp)
+	{
+		PatrolRouteComp->PausePatrol();
+	}
+	// The turn below has to replicate, so a dormant guard must wake up before it
+	FlushNetDormancy();
+
 	FVector LookAtDirection = Location - GetActorLocation();
 	LookAtDirection.Normalize();
 
@@ -73,7 +351,7 @@ void AFPSAICharacter::OnNoiseHeard(APawn* NoiseInstigator, const FVector& Locati
 	SetActorRotation(LookAtRotation);
 
 	GetWorldTimerManager().ClearTimer(TimerHandle_ResetOrientation);
-	GetWorldTimerManager().SetTimer(TimerHandle_ResetOrientation, this, &AFPSAICharacter::ResetOrientation, 3.0f);
+	GetWorldTimerManager().SetTimer(TimerHandle_ResetOrientation, this, &AFPSAICharacter::ResetOrientation, GetGuardConfig()->ResetOrientationDelay);
 
 	ChangeGuardState(EAIState::Suspicious);
 }
@@ -82,6 +360,15 @@ void AFPSAICharacter::ResetOrientation()
 {
 	// If gaurd can see player at new rotation do not reset rotation
 	if (GuardState == EAIState::Alerted) { return; }
+
+	// Patrolling guards walk back to their route instead of snapping back to where they were facing
+	if (HasPatrolRoute())
+	{
+		ChangeGuardState(EAIState::Idle);
+		PatrolRouteComp->ResumePatrol();
+		return;
+	}
+	// Rotate first, going Idle can put the guard to sleep on the network
 	SetActorRotation(OriginalRotation);
 	ChangeGuardState(EAIState::Idle);
 }
@@ -89,8 +376,14 @@ void AFPSAICharacter::ResetOrientation()
 void AFPSAICharacter::ChangeGuardState(EAIState NewState)
 {
 	if (GuardState == NewState) { return; }
+	UpdateNetSettings(NewState);
 	GuardState = NewState;
 
+	if (UFPSSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UFPSSimulationSubsystem>())
+	{
+		Simulation->NotifyGuardStateChanged(NewState);
+	}
+
 	// OnGuardStateChanged(NewState);
 
 	OnRep_GuardState();
@@ -107,9 +400,155 @@ void AFPSAICharacter::ChangeGuardState(EAIState NewState)
 * Things like perception arent run on the client as it's enough to run it on the server.*/
 void AFPSAICharacter::OnRep_GuardState()
 {
+	// The significance manager only catches up on its next update, so don't wait for it to give a guard that reacts full detail
+	if (GuardState != EAIState::Idle)
+	{
+		ApplySignificance(EGuardSignificance::Full);
+	}
+
 	OnGuardStateChanged(GuardState);
 }
 
+void AFPSAICharacter::UpdateNetSettings(EAIState NewState)
+{
+	const UFPSGuardConfig* Config = GetGuardConfig();
+	const bool bPatrolling = HasPatrolRoute();
+
+	/* The guard backs off on its own: a quiet guard gets a low fixed rate or goes dormant below.
+	* Adaptive net update frequency would do the same, but it's a global setting & would slow down players & projectiles too. */
+	switch (NewState)
+	{
+	case EAIState::Alerted:
+		NetUpdateFrequency = Config->AlertedNetUpdateFrequency;
+		break;
+	case EAIState::Suspicious:
+		NetUpdateFrequency = Config->SuspiciousNetUpdateFrequency;
+		break;
+	case EAIState::Idle:
+		NetUpdateFrequency = bPatrolling ? Config->PatrolNetUpdateFrequency : Config->IdleNetUpdateFrequency;
+		break;
+	}
+
+	if (bFacingPlayer)
+	{
+		NetUpdateFrequency = FMath::Max(NetUpdateFrequency, Config->FacingNetUpdateFrequency);
+	}
+
+	/* A guard standing at its post has nothing to send until it hears or sees something or a player walks into its view,
+	* so it goes dormant & costs no bandwidth or replication time at all. Waking up flushes it so the new state goes out straight away. */
+	if (NewState == EAIState::Idle && !bPatrolling && !bFacingPlayer)
+	{
+		SetNetDormancy(DORM_DormantAll);
+	}
+	else
+	{
+		SetNetDormancy(DORM_Awake);
+	}
+}
+
+void AFPSAICharacter::UpdateFacingPlayer()
+{
+	const bool bNowFacing = IsFacingAnyPlayer();
+	if (bNowFacing != bFacingPlayer)
+	{
+		bFacingPlayer = bNowFacing;
+		UpdateNetSettings(GuardState);
+	}
+}
+
+bool AFPSAICharacter::IsFacingAnyPlayer() const
+{
+	if (PawnSensingComp == nullptr)
+	{
+		return false;
+	}
+
+	// Same cone & range the guard sees with, but without the line of sight trace. A player behind a crate may step out any moment.
+	const AFPSGameMode* GM = GetWorld()->GetAuthGameMode<AFPSGameMode>();
+	const float SightRadiusSquared = FMath::Square(PawnSensingComp->SightRadius);
+	const float VisionCosine = PawnSensingComp->GetPeripheralVisionCosine();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+		const APawn* PlayerPawn = PC ? PC->GetPawn() : nullptr;
+		if (PlayerPawn == nullptr || (GM && !GM->AreInSameMatch(this, PlayerPawn)))
+		{
+			continue;
+		}
+
+		const FVector ToPlayer = PlayerPawn->GetActorLocation() - GetActorLocation();
+		if (ToPlayer.SizeSquared() <= SightRadiusSquared
+			&& FVector::DotProduct(GetActorForwardVector(), ToPlayer.GetSafeNormal()) >= VisionCosine)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool AFPSAICharacter::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	// Guards in another match on the same server are never relevant, not even Alerted ones
+	const AFPSGameMode* GM = GetWorld()->GetAuthGameMode<AFPSGameMode>();
+	if (GM && !GM->AreInSameMatch(this, RealViewer))
+	{
+		return false;
+	}
+
+	// Seeing a player ends the mission, everyone should see the guard that did it
+	if (GuardState == EAIState::Alerted)
+	{
+		return true;
+	}
+
+	if (!Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation))
+	{
+		return false;
+	}
+
+	/* An Idle guard far away behind a wall can't be seen, heard or be interesting to the player.
+	* We only trace for guards past OccludedCullDistance, & idle guards are only considered a few times a second, so this stays cheap. */
+	if (GuardState == EAIState::Idle)
+	{
+		const FVector GuardEyes = GetPawnViewLocation();
+		if (FVector::DistSquared(SrcLocation, GuardEyes) > FMath::Square(GetGuardConfig()->OccludedCullDistance))
+		{
+			FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GuardNetRelevancy), false, this);
+			QueryParams.AddIgnoredActor(ViewTarget);
+			if (GetWorld()->LineTraceTestByChannel(SrcLocation, GuardEyes, ECC_Visibility, QueryParams))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+float AFPSAICharacter::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+	float Priority = Super::GetNetPriority(ViewPos, ViewDir, Viewer, ViewTarget, InChannel, Time, bLowBandwidth);
+
+	const UFPSGuardConfig* Config = GetGuardConfig();
+	if (GuardState == EAIState::Alerted)
+	{
+		Priority *= Config->AlertedNetPriorityScale;
+	}
+
+	// A guard that's looking at the player is the one that can catch them, so its rotation needs to be up to date
+	if (PawnSensingComp)
+	{
+		const FVector ToViewer = (ViewPos - GetActorLocation()).GetSafeNormal();
+		if (FVector::DotProduct(GetActorForwardVector(), ToViewer) >= PawnSensingComp->GetPeripheralVisionCosine())
+		{
+			Priority *= Config->FacingNetPriorityScale;
+		}
+	}
+
+	return Priority;
+}
+
 /*We always need this function whenever we need to add a new replicated property. 
 * It's not relevant to replicated functions etc. but anytime a new replicated variable is added, 
 * it must be setup inside of this function to tell Unreal his replication "rules"
@@ -0,0 +1,206 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FPSAlertSubsystem.h"
+#include "FPSAICharacter.h"
+#include "Engine/World.h"
+
+UFPSAlertSubsystem::UFPSAlertSubsystem()
+{
+	SquadCellSize = 2000.0f;
+	SquadRebuildInterval = 1.0f;
+	SquadAlertRadius = 2000.0f;
+	LeaderRelayRadius = 4000.0f;
+	MaxRelayFanOut = 3;
+	MaxHops = 2;
+	LeaderAlertCooldown = 2.0f;
+	MaxAlertsPerFrame = 64;
+
+	TimeSinceSquadRebuild = 0.0f;
+	bSquadsDirty = true;
+}
+
+void UFPSAlertSubsystem::Deinitialize()
+{
+	Guards.Empty();
+	Squads.Empty();
+	CellOfGuard.Empty();
+	LastRelayTime.Empty();
+	PendingAlerts.Empty();
+
+	Super::Deinitialize();
+}
+
+void UFPSAlertSubsystem::RegisterGuard(AFPSAICharacter* Guard)
+{
+	if (Guard)
+	{
+		Guards.AddUnique(Guard);
+		bSquadsDirty = true;
+	}
+}
+
+void UFPSAlertSubsystem::UnregisterGuard(AFPSAICharacter* Guard)
+{
+	// The squads hold raw pointers, so they're rebuilt before the next alert is handled
+	Guards.Remove(Guard);
+	LastRelayTime.Remove(Guard);
+	bSquadsDirty = true;
+}
+
+void UFPSAlertSubsystem::RaiseAlert(AFPSAICharacter* Source, const FVector& Location)
+{
+	if (Source)
+	{
+		PendingAlerts.Add({ Source, Location, MaxHops });
+	}
+}
+
+void UFPSAlertSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeSinceSquadRebuild += DeltaTime;
+
+	// Squads are only needed to spread alerts, so a quiet level doesn't pay for them at all
+	if (PendingAlerts.Num() == 0)
+	{
+		return;
+	}
+
+	if (bSquadsDirty || TimeSinceSquadRebuild >= SquadRebuildInterval)
+	{
+		RebuildSquads();
+	}
+
+	// Relays queued while handling this batch go to the back, so they're handled next frame
+	const int32 NumToHandle = FMath::Min(PendingAlerts.Num(), FMath::Max(MaxAlertsPerFrame, 1));
+	TArray<FPendingAlert> Batch(PendingAlerts.GetData(), NumToHandle);
+	PendingAlerts.RemoveAt(0, NumToHandle, false);
+
+	// Several alerts about the same intruder usually come in on the same frame, each guard only needs to hear about one
+	TSet<AFPSAICharacter*> AlertedThisFrame;
+	for (const FPendingAlert& Alert : Batch)
+	{
+		AFPSAICharacter* Source = Alert.Source.Get();
+		const FIntPoint* Cell = Source ? CellOfGuard.Find(Source) : nullptr;
+		if (Cell)
+		{
+			SpreadAlert(Alert, *Cell, AlertedThisFrame);
+		}
+	}
+}
+
+FIntPoint UFPSAlertSubsystem::GetCell(const FVector& Location) const
+{
+	const float CellSize = FMath::Max(SquadCellSize, 1.0f);
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void UFPSAlertSubsystem::RebuildSquads()
+{
+	TimeSinceSquadRebuild = 0.0f;
+	bSquadsDirty = false;
+
+	Squads.Reset();
+	CellOfGuard.Reset();
+
+	Guards.RemoveAll([](const TWeakObjectPtr<AFPSAICharacter>& Guard) { return !Guard.IsValid(); });
+	for (const TWeakObjectPtr<AFPSAICharacter>& GuardPtr : Guards)
+	{
+		AFPSAICharacter* Guard = GuardPtr.Get();
+		const FIntPoint Cell = GetCell(Guard->GetActorLocation());
+		Squads.FindOrAdd(Cell).Members.Add(Guard);
+		CellOfGuard.Add(Guard, Cell);
+	}
+
+	// The guard closest to the middle of the cell leads, so it can reach the whole squad
+	const float CellSize = FMath::Max(SquadCellSize, 1.0f);
+	for (TPair<FIntPoint, FSquad>& SquadPair : Squads)
+	{
+		const FVector CellCenter((SquadPair.Key.X + 0.5f) * CellSize, (SquadPair.Key.Y + 0.5f) * CellSize, 0.0f);
+
+		float BestDistanceSquared = MAX_flt;
+		for (AFPSAICharacter* Member : SquadPair.Value.Members)
+		{
+			const float DistanceSquared = FVector::DistSquared2D(Member->GetActorLocation(), CellCenter);
+			if (DistanceSquared < BestDistanceSquared)
+			{
+				BestDistanceSquared = DistanceSquared;
+				SquadPair.Value.Leader = Member;
+			}
+		}
+	}
+}
+
+void UFPSAlertSubsystem::SpreadAlert(const FPendingAlert& Alert, const FIntPoint& Cell, TSet<AFPSAICharacter*>& AlertedThisFrame)
+{
+	const FSquad* Squad = Squads.Find(Cell);
+	if (Squad == nullptr || Squad->Leader == nullptr)
+	{
+		return;
+	}
+	AFPSAICharacter* Leader = Squad->Leader;
+
+	// A leader that has just passed an alert on has already put its squad & neighbours on it
+	const float Now = GetWorld()->GetTimeSeconds();
+	if (const float* LastTime = LastRelayTime.Find(Leader))
+	{
+		if (Now - *LastTime < LeaderAlertCooldown)
+		{
+			return;
+		}
+	}
+	LastRelayTime.Add(Leader, Now);
+
+	// ReceiveAlert ignores guards that are already Alerted, which includes the guard that raised the alert
+	const FVector LeaderLocation = Leader->GetActorLocation();
+	for (AFPSAICharacter* Member : Squad->Members)
+	{
+		if (FVector::DistSquared(Member->GetActorLocation(), LeaderLocation) <= FMath::Square(SquadAlertRadius)
+			&& !AlertedThisFrame.Contains(Member))
+		{
+			AlertedThisFrame.Add(Member);
+			Member->ReceiveAlert(Alert.Location);
+		}
+	}
+
+	if (Alert.HopsLeft <= 0 || MaxRelayFanOut <= 0)
+	{
+		return;
+	}
+
+	// Only the cells that can be in relay range are looked at, never the whole level
+	const int32 CellRange = FMath::CeilToInt(LeaderRelayRadius / FMath::Max(SquadCellSize, 1.0f));
+	TArray<TPair<float, AFPSAICharacter*>> NearbyLeaders;
+	for (int32 Y = -CellRange; Y <= CellRange; Y++)
+	{
+		for (int32 X = -CellRange; X <= CellRange; X++)
+		{
+			const FSquad* OtherSquad = (X == 0 && Y == 0) ? nullptr : Squads.Find(Cell + FIntPoint(X, Y));
+			if (OtherSquad == nullptr || OtherSquad->Leader == nullptr)
+			{
+				continue;
+			}
+
+			const float DistanceSquared = FVector::DistSquared(OtherSquad->Leader->GetActorLocation(), LeaderLocation);
+			if (DistanceSquared <= FMath::Square(LeaderRelayRadius))
+			{
+				NearbyLeaders.Emplace(DistanceSquared, OtherSquad->Leader);
+			}
+		}
+	}
+
+	NearbyLeaders.Sort([](const TPair<float, AFPSAICharacter*>& A, const TPair<float, AFPSAICharacter*>& B) { return A.Key < B.Key; });
+
+	const int32 NumRelays = FMath::Min(NearbyLeaders.Num(), MaxRelayFanOut);
+	for (int32 RelayIndex = 0; RelayIndex < NumRelays; RelayIndex++)
+	{
+		PendingAlerts.Add({ NearbyLeaders[RelayIndex].Value, Alert.Location, Alert.HopsLeft - 1 });
+	}
+}
+
+TStatId UFPSAlertSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFPSAlertSubsystem, STATGROUP_Tickables);
+}
@@ -4,13 +4,21 @@
 #include "FPSProjectile.h"
 #include "Animation/AnimInstance.h"
 #include "Camera/CameraComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/SkeletalMeshSocket.h"
+#include "AnimationRuntime.h"
 #include "Components/CapsuleComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Components/PawnNoiseEmitterComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "FPSLoadTestSubsystem.h"
 
 
 AFPSCharacter::AFPSCharacter()
 {
+	/* The camera & first person meshes are only ever seen by the player controlling this character.
+	* They are still created on dedicated servers so BP_Player's settings for them load & cook the same everywhere,
+	* but they're never registered there, see PreRegisterAllComponents. */
 	// Create a CameraComponent	
 	CameraComponent = CreateDefaultSubobject<UCameraComponent>(TEXT("FirstPersonCamera"));
 	CameraComponent->SetupAttachment(GetCapsuleComponent());
@@ -30,6 +38,40 @@ AFPSCharacter::AFPSCharacter()
 	GunMeshComponent->SetupAttachment(Mesh1PComponent, "GripPoint");
 
 	NoiseEmittingComp = CreateDefaultSubobject<UPawnNoiseEmitterComponent>(TEXT("NoiseEmittingComp"));
+
+	// Only used if the gun mesh has no "Muzzle" socket, see GetMuzzleOffset()
+	MuzzleOffset = FVector(100.0f, 0.0f, 10.0f);
+	bMuzzleOffsetCached = false;
+	CachedMuzzleOffset = FVector::ZeroVector;
+}
+
+void AFPSCharacter::PreRegisterAllComponents()
+{
+	Super::PreRegisterAllComponents();
+
+	/* Nobody looks through a dedicated server's camera or at its first person arms & gun.
+	* Unregistered components have no transforms to update, no anim instance, no physics & no tick, in every build target. */
+	if (GetNetMode() == NM_DedicatedServer)
+	{
+		for (USceneComponent* CosmeticComp : TArray<USceneComponent*>{ CameraComponent, Mesh1PComponent, GunMeshComponent })
+		{
+			if (CosmeticComp)
+			{
+				CosmeticComp->bAutoRegister = false;
+			}
+		}
+	}
+}
+
+void AFPSCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// The actor tick only networks the camera pitch for other players' arms, which is only visual
+	if (GetNetMode() == NM_DedicatedServer)
+	{
+		SetActorTickEnabled(false);
+	}
 }
 
 
@@ -63,7 +105,7 @@ void AFPSCharacter::Fire()
 	if (FireAnimation)
 	{
 		// Get the animation object for the arms mesh
-		UAnimInstance* AnimInstance = Mesh1PComponent->GetAnimInstance();
+		UAnimInstance* AnimInstance = Mesh1PComponent ? Mesh1PComponent->GetAnimInstance() : nullptr;
 		if (AnimInstance)
 		{
 			AnimInstance->PlaySlotAnimationAsDynamicMontage(FireAnimation, "Arms", 0.0f);
@@ -77,11 +119,17 @@ void AFPSCharacter::ServerFire_Implementation()
 	/* We can't direct the server to replicate a projectile. Instead we let the server spawn projectiles.
 	 * Moreover, the server aldready replicates projectiles so letting the client do so will be redundant & will create duplicate copies.
 	 * So we only let the server fire projectiles.*/
+	if (UFPSLoadTestSubsystem* LoadTest = GetWorld()->GetSubsystem<UFPSLoadTestSubsystem>())
+	{
+		LoadTest->CountServerFire();
+	}
+
 	// try and fire a projectile
 	if (ProjectileClass)
 	{
-		FVector MuzzleLocation = GunMeshComponent->GetSocketLocation("Muzzle");
-		FRotator MuzzleRotation = GunMeshComponent->GetSocketRotation("Muzzle");
+		FVector MuzzleLocation;
+		FRotator MuzzleRotation;
+		GetMuzzleTransform(MuzzleLocation, MuzzleRotation);
 
 		//Set Spawn Collision Handling Override
 		FActorSpawnParameters ActorSpawnParams;
@@ -94,10 +142,98 @@ void AFPSCharacter::ServerFire_Implementation()
 	}
 }
 
+void AFPSCharacter::GetMuzzleTransform(FVector& OutLocation, FRotator& OutRotation) const
+{
+	// Wherever the gun is actually posed (clients, listen servers) we keep using its socket
+	if (GunMeshComponent && GunMeshComponent->IsRegistered())
+	{
+		OutLocation = GunMeshComponent->GetSocketLocation("Muzzle");
+		OutRotation = GunMeshComponent->GetSocketRotation("Muzzle");
+		return;
+	}
+
+	/* On the server GetBaseAimRotation() is the controller's rotation, which is the client's real aim.
+	* It's more accurate than the camera pitch rebuilt from RemoteViewPitch, and it needs no mesh, socket or anim update. */
+	OutRotation = GetBaseAimRotation();
+	OutLocation = GetPawnViewLocation() + OutRotation.RotateVector(GetMuzzleOffset());
+}
+
+FVector AFPSCharacter::GetMuzzleOffset() const
+{
+	// Every character of a class has the same meshes, so the offset is worked out once & kept on the class default object
+	AFPSCharacter* DefaultCharacter = GetClass()->GetDefaultObject<AFPSCharacter>();
+	if (!DefaultCharacter->bMuzzleOffsetCached)
+	{
+		DefaultCharacter->bMuzzleOffsetCached = true;
+		if (!DefaultCharacter->ComputeMuzzleOffset(DefaultCharacter->CachedMuzzleOffset))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s has no Muzzle socket on its gun, using MuzzleOffset"), *GetClass()->GetName());
+			DefaultCharacter->CachedMuzzleOffset = MuzzleOffset;
+		}
+	}
+	return DefaultCharacter->CachedMuzzleOffset;
+}
+
+// Where a socket is in its mesh's component space in the reference pose. Works on meshes that were never registered or animated.
+static bool GetRefPoseSocketTransform(const USkeletalMeshComponent* MeshComp, FName SocketName, FTransform& OutTransform)
+{
+	const USkeletalMesh* Mesh = MeshComp ? MeshComp->SkeletalMesh : nullptr;
+	if (Mesh == nullptr)
+	{
+		return false;
+	}
+
+	// Attach points can be sockets or plain bones
+	FName BoneName = SocketName;
+	FTransform SocketLocalTransform = FTransform::Identity;
+	if (const USkeletalMeshSocket* Socket = Mesh->FindSocket(SocketName))
+	{
+		BoneName = Socket->BoneName;
+		SocketLocalTransform = Socket->GetSocketLocalTransform();
+	}
+
+	const FReferenceSkeleton& RefSkeleton = Mesh->GetRefSkeleton();
+	const int32 BoneIndex = RefSkeleton.FindBoneIndex(BoneName);
+	if (BoneIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutTransform = SocketLocalTransform * FAnimationRuntime::GetComponentSpaceTransformRefPose(RefSkeleton, BoneIndex);
+	return true;
+}
+
+bool AFPSCharacter::ComputeMuzzleOffset(FVector& OutOffset) const
+{
+	if (Mesh1PComponent == nullptr || GunMeshComponent == nullptr)
+	{
+		return false;
+	}
+
+	FTransform MuzzleInGun;
+	FTransform GripInArms;
+	if (!GetRefPoseSocketTransform(GunMeshComponent, "Muzzle", MuzzleInGun)
+		|| !GetRefPoseSocketTransform(Mesh1PComponent, GunMeshComponent->GetAttachSocketName(), GripInArms))
+	{
+		return false;
+	}
+
+	/* Walks the same attachment chain the client uses (muzzle -> gun -> arms' grip point -> arms -> camera) in the reference pose.
+	* The camera sits at the pawn's view location & turns with the aim, so this is the muzzle in aim space.
+	* The client's arms are animated, so its socket can sway a few units around this. */
+	const FTransform MuzzleInCamera = MuzzleInGun * GunMeshComponent->GetRelativeTransform() * GripInArms * Mesh1PComponent->GetRelativeTransform();
+	OutOffset = MuzzleInCamera.GetLocation();
+	return true;
+}
+
 bool AFPSCharacter::ServerFire_Validate()
 {
 	/*This function is used on server side for sanity checks & lets us perform checks & detect cheating etc.
 	* For now we assume the validation is true & the function is always executed properly */
+	if (UFPSLoadTestSubsystem* LoadTest = GetWorld()->GetSubsystem<UFPSLoadTestSubsystem>())
+	{
+		LoadTest->CountServerFireValidate();
+	}
 	return true;
 }
 
@@ -135,7 +271,7 @@ void AFPSCharacter::Tick(float DeltaTime)
 	* My machine's character pitch is being manipulated using the input component.
 	* To simulate the pitch of the other players' characters, we change the pitch of the local copies of the player on our machine
 	* To do this we use the in-built RemoteViewPitch which stores the pitch of the other clients*/
-	if (!IsLocallyControlled()) // Do this for player characters not controlled by us
+	if (CameraComponent && !IsLocallyControlled()) // Do this for player characters not controlled by us
 	{
 		FRotator NewRotation = CameraComponent->GetRelativeRotation(); 
 		/* We didn't use something more direct such as the mesh component because the origin of the mesh component was at a different postion 
@@ -150,4 +286,12 @@ void AFPSCharacter::Tick(float DeltaTime)
 		So we get the NewRemotePitch value as that will be between 0-360*/
 		CameraComponent->SetRelativeRotation(NewRotation);
 	}
+}
+
+void AFPSCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Other players don't need to know what we're carrying
+	DOREPLIFETIME_CONDITION(AFPSCharacter, bIsCarryingObjective, COND_OwnerOnly);
 }
\ No newline at end of file
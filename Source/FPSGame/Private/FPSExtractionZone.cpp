@@ -7,6 +7,7 @@
 #include "FPSCharacter.h"
 #include "FPSGameMode.h"
 #include "Kismet/GameplayStatics.h"
+#include "FPSMissionStateComponent.h"
 
 // Sets default values
 AFPSExtractionZone::AFPSExtractionZone()
@@ -27,6 +28,22 @@ AFPSExtractionZone::AFPSExtractionZone()
 	DecalComp->DecalSize = FVector(200.0f);
 }
 
+void AFPSExtractionZone::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (HasAuthority())
+	{
+		AFPSGameMode* GM = Cast<AFPSGameMode>(GetWorld()->GetAuthGameMode());
+		UFPSMissionStateComponent* MissionState = UFPSMissionStateComponent::Get(this);
+		if (GM && MissionState)
+		{
+			TeamId = GM->GetMissionTeamId(this);
+			ZoneIndex = MissionState->RegisterExtractionZone(TeamId);
+		}
+	}
+}
+
 void AFPSExtractionZone::HandleOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
 	int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
@@ -41,10 +58,25 @@ void AFPSExtractionZone::HandleOverlap(UPrimitiveComponent* OverlappedComponent,
 	{
 		// AuthGameMode only works on server & not client. Will look into it later
 		AFPSGameMode* GM = Cast<AFPSGameMode>(GetWorld()->GetAuthGameMode());
-		if (GM)
+		UFPSMissionStateComponent* MissionState = UFPSMissionStateComponent::Get(this);
+		if (GM && MissionState == nullptr)
 		{
+			// Game modes without AFPSGameState have no mission state, there the first objective home wins like it used to
 			GM->CompleteMission(MyPawn, true);
 		}
+		else if (GM)
+		{
+			/* The mission state keeps a running count of what's left per team, so handing in objectives
+			* tells us straight away whether that was the last one. The mission only ends once every objective is home. */
+			const bool bAllExtracted = MissionState->NotifyObjectivesExtracted(TeamId, ZoneIndex, MyPawn->CarriedObjectives);
+			MyPawn->CarriedObjectives.Reset();
+			MyPawn->bIsCarryingObjective = false;
+
+			if (bAllExtracted)
+			{
+				GM->CompleteMission(MyPawn, true);
+			}
+		}
 	}
 	else
 	{
@@ -3,8 +3,16 @@
 #include "FPSGameMode.h"
 #include "FPSHUD.h"
 #include "FPSCharacter.h"
+#include "FPSGameState.h"
+#include "FPSPlayerController.h"
+#include "FPSMissionStateComponent.h"
+#include "FPSSimulationSubsystem.h"
 #include "UObject/ConstructorHelpers.h"
 #include "Kismet/GameplayStatics.h"
+#include "Engine/LevelStreamingDynamic.h"
+#include "GameFramework/PlayerStart.h"
+#include "GameFramework/GameSession.h"
+#include "EngineUtils.h"
 
 AFPSGameMode::AFPSGameMode()
 {
@@ -14,6 +22,17 @@ AFPSGameMode::AFPSGameMode()
 
 	// use our custom HUD class
 	HUDClass = AFPSHUD::StaticClass();
+
+	// Holds the mission state so clients can see it too
+	GameStateClass = AFPSGameState::StaticClass();
+
+	// Plays like the default controller, but can also run as a load test bot
+	PlayerControllerClass = AFPSPlayerController::StaticClass();
+
+	MaxPlayersPerMatch = 2;
+	MaxMatchInstances = 16;
+	MatchInstanceSpacing = 200000.0f;
+	NumMatchesCreated = 0;
 }
 
 void AFPSGameMode::CompleteMission(APawn* InstigatorPawn, bool bMissionSuccess)
@@ -26,10 +45,12 @@ void AFPSGameMode::CompleteMission(APawn* InstigatorPawn, bool bMissionSuccess)
 		{
 			TArray<AActor*> ReturnedActors;
 			UGameplayStatics::GetAllActorsOfClass(this, SpectatingViewpointClass, ReturnedActors);
-			AActor* NewViewTarget = ReturnedActors[0];
+			// When hosting several matches every match level has its own viewpoint, use the one in the instigator's match
+			AActor** FoundViewTarget = ReturnedActors.FindByPredicate([this, InstigatorPawn](const AActor* Viewpoint) { return AreInSameMatch(Viewpoint, InstigatorPawn); });
+			AActor* NewViewTarget = FoundViewTarget ? *FoundViewTarget : nullptr;
 
 			APlayerController* PC = Cast<APlayerController>(InstigatorPawn->GetController());
-			if (PC)
+			if (PC && NewViewTarget)
 			{
 				PC->SetViewTargetWithBlend(NewViewTarget, 0.5f, VTBlend_Cubic);
 			}
@@ -39,6 +60,372 @@ void AFPSGameMode::CompleteMission(APawn* InstigatorPawn, bool bMissionSuccess)
 			UE_LOG(LogTemp, Warning, TEXT("SpectatingViewportClass empty. Assign class in GameMode BP"));
 		}
 
+		if (FFPSMatchInstance* Match = FindMatchForController(InstigatorPawn->GetController()))
+		{
+			Match->bMissionComplete = true;
+		}
+
 		OnMissionCompleted(InstigatorPawn, bMissionSuccess);
+
+		if (UFPSSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UFPSSimulationSubsystem>())
+		{
+			Simulation->NotifyMissionComplete(bMissionSuccess);
+		}
+	}
+}
+
+int32 AFPSGameMode::GetMatchIdForActor(const AActor* Actor) const
+{
+	if (!IsHostingMatchInstances() || Actor == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	// Guards, objectives, zones etc. live in their match's level
+	const ULevel* ActorLevel = Actor->GetLevel();
+	for (const FFPSMatchInstance& Match : MatchInstances)
+	{
+		if (Match.IsInUse() && Match.LevelStreaming->GetLoadedLevel() == ActorLevel)
+		{
+			return Match.MatchId;
+		}
+	}
+
+	// Players & their pawns are spawned in the persistent level, so we go by the match they were put in
+	const AController* Controller = Cast<AController>(Actor);
+	if (Controller == nullptr)
+	{
+		if (const APawn* Pawn = Cast<APawn>(Actor))
+		{
+			Controller = Pawn->GetController();
+		}
+	}
+	if (Controller)
+	{
+		for (const FFPSMatchInstance& Match : MatchInstances)
+		{
+			if (Match.Players.Contains(Controller))
+			{
+				return Match.MatchId;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	// Projectiles belong to the match of whoever fired them
+	const APawn* ActorInstigator = Actor->GetInstigator();
+	if (ActorInstigator && ActorInstigator != Actor)
+	{
+		return GetMatchIdForActor(ActorInstigator);
+	}
+
+	return INDEX_NONE;
+}
+
+// Match ids 0 to InvalidTeamId - 1 are used as team ids, that only works if InvalidTeamId is the largest value a team id can hold
+static_assert(UFPSMissionStateComponent::InvalidTeamId == TNumericLimits<decltype(FFPSMissionBitsItem::TeamId)>::Max(), "InvalidTeamId has to be the largest team id");
+
+uint8 AFPSGameMode::GetMissionTeamId(const AActor* Actor) const
+{
+	if (!IsHostingMatchInstances())
+	{
+		return 0;
+	}
+
+	const int32 MatchId = GetMatchIdForActor(Actor);
+	if (MatchId == INDEX_NONE)
+	{
+		return UFPSMissionStateComponent::InvalidTeamId;
+	}
+
+	check(MatchId >= 0 && MatchId < UFPSMissionStateComponent::InvalidTeamId);
+	return (uint8)MatchId;
+}
+
+int32 AFPSGameMode::GetMaxMatchInstances() const
+{
+	return FMath::Clamp(MaxMatchInstances, 0, (int32)UFPSMissionStateComponent::InvalidTeamId);
+}
+
+bool AFPSGameMode::AreInSameMatch(const AActor* A, const AActor* B) const
+{
+	const int32 MatchIdA = GetMatchIdForActor(A);
+	const int32 MatchIdB = GetMatchIdForActor(B);
+	return MatchIdA == INDEX_NONE || MatchIdB == INDEX_NONE || MatchIdA == MatchIdB;
+}
+
+void AFPSGameMode::PreLogin(const FString& Options, const FString& Address, const FUniqueNetIdRepl& UniqueId, FString& ErrorMessage)
+{
+	Super::PreLogin(Options, Address, UniqueId, ErrorMessage);
+
+	// A non empty ErrorMessage rejects the login & is shown to the joining player
+	if (ErrorMessage.IsEmpty() && IsHostingMatchInstances() && !HasRoomForNewPlayer())
+	{
+		ErrorMessage = TEXT("Every match on this server is full, try again later");
+	}
+}
+
+void AFPSGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	if (!IsHostingMatchInstances())
+	{
+		Super::HandleStartingNewPlayer_Implementation(NewPlayer);
+		return;
+	}
+
+	FFPSMatchInstance* Match = FindOrCreateMatchForPlayer(NewPlayer);
+	if (Match == nullptr)
+	{
+		/* PreLogin turns players away while everything is full, but several players can pass it before the first of them gets here,
+		* or the match level can fail to load. They're kicked rather than left connected without a pawn. */
+		UE_LOG(LogTemp, Warning, TEXT("No free match instance for %s, raise MaxMatchInstances in GameMode BP"), *GetNameSafe(NewPlayer));
+		if (GameSession)
+		{
+			GameSession->KickPlayer(NewPlayer, NSLOCTEXT("FPSGame", "MatchesFull", "Every match on this server is full, try again later"));
+		}
+		return;
+	}
+
+	/* The engine only tells clients about levels that were streamed in before they joined, & then about all of them.
+	* So each player is sent just its own match's copy, & never streams in the matches it isn't part of. */
+	if (AFPSPlayerController* FPSPC = Cast<AFPSPlayerController>(NewPlayer))
+	{
+		if (!FPSPC->IsLocalController())
+		{
+			FPSPC->ClientLoadMatchLevel(MatchLevel, Match->Origin, Match->LevelName);
+		}
+	}
+
+	// Can't spawn the player until their match has player starts to spawn at, on the server & on their machine
+	Match->PendingPlayers.AddUnique(NewPlayer);
+	StartPendingPlayers(*Match);
+}
+
+AActor* AFPSGameMode::ChoosePlayerStart_Implementation(AController* Player)
+{
+	/* This is also called when a player logs in, before they have a match. Any start is fine then,
+	* ShouldSpawnAtStartSpot makes sure it isn't used when the player is actually spawned. */
+	FFPSMatchInstance* Match = FindMatchForController(Player);
+	const ULevel* MatchLevelInstance = Match ? Match->LevelStreaming->GetLoadedLevel() : nullptr;
+	if (MatchLevelInstance == nullptr)
+	{
+		return Super::ChoosePlayerStart_Implementation(Player);
+	}
+
+	// Every copy of the match level has the same player starts, only the ones in this player's copy count
+	TArray<APlayerStart*> MatchStarts;
+	for (TActorIterator<APlayerStart> It(GetWorld()); It; ++It)
+	{
+		if (It->GetLevel() == MatchLevelInstance)
+		{
+			MatchStarts.Add(*It);
+		}
+	}
+
+	// Never fall back to a start in someone else's match
+	if (MatchStarts.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Match level %s has no player starts"), *MatchLevel.ToString());
+		return nullptr;
+	}
+	return MatchStarts[FMath::RandRange(0, MatchStarts.Num() - 1)];
+}
+
+bool AFPSGameMode::ShouldSpawnAtStartSpot_Implementation(AController* Player)
+{
+	// The start picked at login was picked before the player had a match, so it can be in any match's level
+	if (IsHostingMatchInstances())
+	{
+		return false;
+	}
+	return Super::ShouldSpawnAtStartSpot_Implementation(Player);
+}
+
+void AFPSGameMode::ReplicateStreamingStatus(APlayerController* PC)
+{
+	if (!IsHostingMatchInstances())
+	{
+		Super::ReplicateStreamingStatus(PC);
+		return;
+	}
+
+	/* The engine would send a joining client the status of every streamed level, which includes every other match's copy.
+	* Players get their own match's copy through ClientLoadMatchLevel, so here we only pass on the host map's own sublevels. */
+	if (PC == nullptr || PC->IsLocalController())
+	{
+		return;
+	}
+
+	TArray<FUpdateLevelStreamingLevelStatus> LevelStatuses;
+	for (const ULevelStreaming* LevelStreaming : GetWorld()->GetStreamingLevels())
+	{
+		const bool bIsMatchLevel = MatchInstances.ContainsByPredicate([LevelStreaming](const FFPSMatchInstance& Match) { return Match.LevelStreaming == LevelStreaming; });
+		if (LevelStreaming == nullptr || bIsMatchLevel)
+		{
+			continue;
+		}
+
+		FUpdateLevelStreamingLevelStatus& LevelStatus = LevelStatuses.AddDefaulted_GetRef();
+		LevelStatus.PackageName = PC->NetworkRemapPath(LevelStreaming->GetWorldAssetPackageFName(), false);
+		LevelStatus.LODIndex = LevelStreaming->GetLevelLODIndex();
+		LevelStatus.bNewShouldBeLoaded = LevelStreaming->ShouldBeLoaded();
+		LevelStatus.bNewShouldBeVisible = LevelStreaming->ShouldBeVisible();
+		LevelStatus.bNewShouldBlockOnLoad = LevelStreaming->bShouldBlockOnLoad;
+	}
+
+	if (LevelStatuses.Num() > 0)
+	{
+		PC->ClientUpdateMultipleLevelsStreamingStatus(LevelStatuses);
+		PC->ClientFlushLevelStreaming();
+	}
+}
+
+void AFPSGameMode::Logout(AController* Exiting)
+{
+	if (FFPSMatchInstance* Match = FindMatchForController(Exiting))
+	{
+		Match->Players.Remove(Exiting);
+		Match->PendingPlayers.Remove(Cast<APlayerController>(Exiting));
+
+		// Last one out unloads the level & frees up the slot for the next match
+		if (Match->Players.Num() == 0)
+		{
+			Match->LevelStreaming->OnLevelShown.RemoveDynamic(this, &AFPSGameMode::OnMatchLevelShown);
+			Match->LevelStreaming->SetIsRequestingUnloadAndRemoval(true);
+			*Match = FFPSMatchInstance();
+		}
+	}
+
+	Super::Logout(Exiting);
+}
+
+bool AFPSGameMode::HasRoomForNewPlayer() const
+{
+	// Same order as FindOrCreateMatchForPlayer: a match that can take another player, then a free or new slot
+	for (const FFPSMatchInstance& Match : MatchInstances)
+	{
+		if (!Match.IsInUse() || (!Match.bMissionComplete && Match.Players.Num() < MaxPlayersPerMatch))
+		{
+			return true;
+		}
+	}
+	return MatchInstances.Num() < GetMaxMatchInstances();
+}
+
+FFPSMatchInstance* AFPSGameMode::FindMatchForController(const AController* Controller)
+{
+	if (Controller == nullptr)
+	{
+		return nullptr;
+	}
+
+	return MatchInstances.FindByPredicate([Controller](const FFPSMatchInstance& Match)
+	{
+		return Match.IsInUse() && Match.Players.Contains(Controller);
+	});
+}
+
+FFPSMatchInstance* AFPSGameMode::FindOrCreateMatchForPlayer(APlayerController* NewPlayer)
+{
+	if (FFPSMatchInstance* ExistingMatch = FindMatchForController(NewPlayer))
+	{
+		return ExistingMatch;
+	}
+
+	// Fill up matches that haven't finished yet before starting new ones
+	FFPSMatchInstance* Match = MatchInstances.FindByPredicate([this](const FFPSMatchInstance& Candidate)
+	{
+		return Candidate.IsInUse() && !Candidate.bMissionComplete && Candidate.Players.Num() < MaxPlayersPerMatch;
+	});
+
+	if (Match == nullptr)
+	{
+		int32 SlotIndex = MatchInstances.IndexOfByPredicate([](const FFPSMatchInstance& Candidate) { return !Candidate.IsInUse(); });
+		if (SlotIndex == INDEX_NONE)
+		{
+			if (MatchInstances.Num() >= GetMaxMatchInstances())
+			{
+				return nullptr;
+			}
+			SlotIndex = MatchInstances.AddDefaulted();
+		}
+
+		/* The level is streamed in asynchronously so other matches on this server don't hitch.
+		* Only the first copy has to load the assets the level uses from disk, later copies find them already in memory. */
+		bool bSuccess = false;
+		const FVector MatchOrigin(MatchInstanceSpacing * SlotIndex, 0.0f, 0.0f);
+		const FString LevelName = FString::Printf(TEXT("FPSMatch_%d_%d"), SlotIndex, NumMatchesCreated++);
+		ULevelStreamingDynamic* LevelStreaming = ULevelStreamingDynamic::LoadLevelInstanceBySoftObjectPtr(this, MatchLevel, MatchOrigin, FRotator::ZeroRotator, bSuccess, LevelName);
+		if (!bSuccess || LevelStreaming == nullptr)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Couldn't load match level %s"), *MatchLevel.ToString());
+			return nullptr;
+		}
+		LevelStreaming->OnLevelShown.AddDynamic(this, &AFPSGameMode::OnMatchLevelShown);
+
+		// A reused slot must not inherit the objectives of the match that had it before
+		if (UFPSMissionStateComponent* MissionState = UFPSMissionStateComponent::Get(this))
+		{
+			MissionState->ResetTeam((uint8)SlotIndex);
+		}
+
+		Match = &MatchInstances[SlotIndex];
+		Match->LevelStreaming = LevelStreaming;
+		Match->MatchId = SlotIndex;
+		Match->bMissionComplete = false;
+		Match->Origin = MatchOrigin;
+		Match->LevelName = LevelName;
+	}
+
+	Match->Players.Add(NewPlayer);
+	return Match;
+}
+
+void AFPSGameMode::OnMatchLevelShown()
+{
+	// The delegate doesn't say which level was shown, so check every match
+	for (FFPSMatchInstance& Match : MatchInstances)
+	{
+		if (Match.IsInUse())
+		{
+			StartPendingPlayers(Match);
+		}
+	}
+}
+
+void AFPSGameMode::NotifyMatchLevelLoaded(APlayerController* PC)
+{
+	if (FFPSMatchInstance* Match = FindMatchForController(PC))
+	{
+		StartPendingPlayers(*Match);
+	}
+}
+
+void AFPSGameMode::StartPendingPlayers(FFPSMatchInstance& Match)
+{
+	if (!Match.LevelStreaming->IsLevelVisible())
+	{
+		return;
+	}
+
+	// Players whose machine hasn't shown the level yet would spawn with no floor under them, they keep waiting
+	TArray<APlayerController*> PlayersToStart;
+	for (int32 Index = Match.PendingPlayers.Num() - 1; Index >= 0; Index--)
+	{
+		APlayerController* PC = Match.PendingPlayers[Index];
+		const AFPSPlayerController* FPSPC = Cast<AFPSPlayerController>(PC);
+		if (PC == nullptr || FPSPC == nullptr || FPSPC->HasMatchLevelLoaded())
+		{
+			Match.PendingPlayers.RemoveAt(Index);
+			if (PC)
+			{
+				PlayersToStart.Add(PC);
+			}
+		}
+	}
+
+	for (APlayerController* PC : PlayersToStart)
+	{
+		Super::HandleStartingNewPlayer_Implementation(PC);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,10 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FPSGameState.h"
+#include "FPSMissionStateComponent.h"
+
+AFPSGameState::AFPSGameState()
+{
+	MissionStateComp = CreateDefaultSubobject<UFPSMissionStateComponent>(TEXT("MissionStateComp"));
+}
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FPSGuardConfig.h"
+
+UFPSGuardConfig::UFPSGuardConfig()
+{
+	// Same defaults as UPawnSensingComponent so an empty asset doesn't change how guards behave
+	SightRadius = 5000.0f;
+	PeripheralVisionAngle = 90.0f;
+	HearingThreshold = 1400.0f;
+	LOSHearingThreshold = 2800.0f;
+	SensingInterval = 0.5f;
+
+	ResetOrientationDelay = 3.0f;
+
+	bScaleBySignificance = true;
+	FullDetailDistance = 1500.0f;
+	ReducedDetailDistance = 5000.0f;
+	ViewConeHalfAngle = 60.0f;
+	ReducedTickInterval = 0.1f;
+	MinimalTickInterval = 0.25f;
+
+	AlertedNetUpdateFrequency = 60.0f;
+	SuspiciousNetUpdateFrequency = 30.0f;
+	FacingNetUpdateFrequency = 30.0f;
+	FacingCheckInterval = 0.5f;
+	PatrolNetUpdateFrequency = 10.0f;
+	IdleNetUpdateFrequency = 2.0f;
+	OccludedCullDistance = 3000.0f;
+	AlertedNetPriorityScale = 4.0f;
+	FacingNetPriorityScale = 2.0f;
+
+	bDrawDebugSpheres = true;
+	DebugSphereDuration = 10.0f;
+}
@@ -9,9 +9,14 @@
 
 AFPSHUD::AFPSHUD()
 {
+	/* The HUD is never spawned on a dedicated server but its CDO still is, which would load the texture into every server process.
+	* The Server target skips the load, DrawHUD never runs there anyway. */
+	CrosshairTex = nullptr;
+#if !UE_SERVER
 	// Set the crosshair texture
 	static ConstructorHelpers::FObjectFinder<UTexture2D> CrosshairTexObj(TEXT("/Game/UI/FirstPersonCrosshair"));
 	CrosshairTex = CrosshairTexObj.Object;
+#endif
 }
 
 
@@ -19,6 +24,11 @@ void AFPSHUD::DrawHUD()
 {
 	Super::DrawHUD();
 
+	if (CrosshairTex == nullptr)
+	{
+		return;
+	}
+
 	// Draw very simple crosshair
 
 	// find center of the Canvas
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FPSLoadTestSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+
+bool UFPSLoadTestSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer) || !FParse::Param(FCommandLine::Get(), TEXT("FPSLoadTest")))
+	{
+		return false;
+	}
+
+	// Clients have nothing to measure, it's the server we're stressing
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && World->GetNetMode() != NM_Client;
+}
+
+void UFPSLoadTestSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ReportInterval = 5.0f;
+	FParse::Value(FCommandLine::Get(), TEXT("FPSLoadTestInterval="), ReportInterval);
+	ReportInterval = FMath::Max(ReportInterval, 0.5f);
+
+	TimeSinceReport = 0.0f;
+	TickTimeSum = 0.0;
+	TickTimeMax = 0.0;
+	NumTicks = 0;
+	NumServerFireValidates = 0;
+	NumServerFires = 0;
+
+	ReportPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("LoadTest"), FString::Printf(TEXT("LoadTest_%s.csv"), *FDateTime::Now().ToString()));
+	FFileHelper::SaveStringToFile(TEXT("Time,Connections,AvgTickMs,MaxTickMs,AvgInBytesPerSecPerConn,AvgOutBytesPerSecPerConn,AvgInPacketsPerSecPerConn,AvgOutPacketsPerSecPerConn,ServerFireValidatePerSec,ServerFirePerSec\n"), *ReportPath);
+
+	UE_LOG(LogTemp, Log, TEXT("Load test stats are written to %s"), *ReportPath);
+}
+
+void UFPSLoadTestSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	/* DeltaTime includes the time the server sleeps to stay at its max tick rate, which says nothing about load.
+	* GGameThreadTime is how long the game thread actually worked last frame. */
+	const double GameThreadSeconds = FPlatformTime::ToSeconds(GGameThreadTime);
+	TickTimeSum += GameThreadSeconds;
+	TickTimeMax = FMath::Max(TickTimeMax, GameThreadSeconds);
+	NumTicks++;
+
+	TimeSinceReport += DeltaTime;
+	if (TimeSinceReport >= ReportInterval)
+	{
+		WriteReport();
+	}
+}
+
+TStatId UFPSLoadTestSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFPSLoadTestSubsystem, STATGROUP_Tickables);
+}
+
+void UFPSLoadTestSubsystem::WriteReport()
+{
+	// The net driver already keeps per second rates on every connection, we just average them
+	int32 NumConnections = 0;
+	int64 InBytes = 0, OutBytes = 0, InPackets = 0, OutPackets = 0;
+	if (const UNetDriver* NetDriver = GetWorld()->GetNetDriver())
+	{
+		for (const UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			if (Connection == nullptr)
+			{
+				continue;
+			}
+			NumConnections++;
+			InBytes += Connection->InBytesPerSecond;
+			OutBytes += Connection->OutBytesPerSecond;
+			InPackets += Connection->InPacketsPerSecond;
+			OutPackets += Connection->OutPacketsPerSecond;
+		}
+	}
+	const int32 Divisor = FMath::Max(NumConnections, 1);
+
+	const FString Row = FString::Printf(TEXT("%.1f,%d,%.3f,%.3f,%lld,%lld,%lld,%lld,%.2f,%.2f\n"),
+		GetWorld()->GetTimeSeconds(),
+		NumConnections,
+		NumTicks > 0 ? 1000.0 * TickTimeSum / NumTicks : 0.0,
+		1000.0 * TickTimeMax,
+		InBytes / Divisor,
+		OutBytes / Divisor,
+		InPackets / Divisor,
+		OutPackets / Divisor,
+		NumServerFireValidates / TimeSinceReport,
+		NumServerFires / TimeSinceReport);
+	FFileHelper::SaveStringToFile(Row, *ReportPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	TimeSinceReport = 0.0f;
+	TickTimeSum = 0.0;
+	TickTimeMax = 0.0;
+	NumTicks = 0;
+	NumServerFireValidates = 0;
+	NumServerFires = 0;
+}
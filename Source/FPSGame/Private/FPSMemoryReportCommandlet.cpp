@@ -0,0 +1,156 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FPSMemoryReportCommandlet.h"
+#include "FPSAICharacter.h"
+#include "FPSCharacter.h"
+#include "FPSProjectile.h"
+#include "FPSObjectiveActor.h"
+#include "FPSExtractionZone.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "HAL/PlatformMemory.h"
+
+UFPSMemoryReportCommandlet::UFPSMemoryReportCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UFPSMemoryReportCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+	int32 Count = 1;
+	if (const FString* CountParam = ParamVals.Find(TEXT("Count")))
+	{
+		Count = FMath::Max(1, FCString::Atoi(**CountParam));
+	}
+
+	// The native classes by default. Pass the BP classes with -Classes= to include meshes & anything else the BPs set up.
+	TArray<UClass*> Classes;
+	if (const FString* ClassesParam = ParamVals.Find(TEXT("Classes")))
+	{
+		TArray<FString> ClassPaths;
+		ClassesParam->ParseIntoArray(ClassPaths, TEXT(","));
+		for (const FString& ClassPath : ClassPaths)
+		{
+			UClass* LoadedClass = LoadObject<UClass>(nullptr, *ClassPath);
+			if (LoadedClass && LoadedClass->IsChildOf(AActor::StaticClass()))
+			{
+				Classes.Add(LoadedClass);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Couldn't load actor class %s"), *ClassPath);
+			}
+		}
+	}
+	else
+	{
+		Classes.Add(AFPSAICharacter::StaticClass());
+		Classes.Add(AFPSCharacter::StaticClass());
+		Classes.Add(AFPSProjectile::StaticClass());
+		Classes.Add(AFPSObjectiveActor::StaticClass());
+		Classes.Add(AFPSExtractionZone::StaticClass());
+	}
+
+	// An empty game world is enough to spawn actors & create their components. Nothing ticks or renders.
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+
+	for (UClass* ActorClass : Classes)
+	{
+		ReportClass(World, ActorClass, Count);
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return 0;
+}
+
+void UFPSMemoryReportCommandlet::MeasureObject(UObject* Object, SIZE_T& OutInstanceBytes, SIZE_T& OutPropertyBytes, SIZE_T& OutResourceBytes)
+{
+	OutInstanceBytes = Object->GetClass()->GetStructureSize();
+
+	// Counting memory through Serialize already adds the object's own size, we only want what the properties allocate on top
+	FArchiveCountMem CountMem(Object);
+	const SIZE_T CountedBytes = CountMem.GetMax();
+	OutPropertyBytes = CountedBytes > OutInstanceBytes ? CountedBytes - OutInstanceBytes : 0;
+
+	OutResourceBytes = Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+}
+
+void UFPSMemoryReportCommandlet::ReportClass(UWorld* World, UClass* ActorClass, int32 Count)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	const uint64 UsedBefore = FPlatformMemory::GetStats().UsedPhysical;
+
+	TArray<AActor*> SpawnedActors;
+	SpawnedActors.Reserve(Count);
+	for (int32 Index = 0; Index < Count; Index++)
+	{
+		// Spread them out so nothing ends up overlapping
+		const FVector Location(200.0f * (Index % 100), 200.0f * (Index / 100), 0.0f);
+		if (AActor* Actor = World->SpawnActor<AActor>(ActorClass, FTransform(Location), SpawnParams))
+		{
+			SpawnedActors.Add(Actor);
+		}
+	}
+
+	const uint64 UsedAfter = FPlatformMemory::GetStats().UsedPhysical;
+
+	if (SpawnedActors.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Couldn't spawn %s"), *ActorClass->GetName());
+		return;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("==== %s"), *ActorClass->GetName());
+	UE_LOG(LogTemp, Display, TEXT("  %-32s %-36s %10s %10s %10s"), TEXT("Object"), TEXT("Class"), TEXT("Instance"), TEXT("Properties"), TEXT("Resources"));
+
+	// Every instance of a class is laid out the same so measuring the first one is enough
+	AActor* SampleActor = SpawnedActors[0];
+	SIZE_T InstanceBytes, PropertyBytes, ResourceBytes;
+	MeasureObject(SampleActor, InstanceBytes, PropertyBytes, ResourceBytes);
+	SIZE_T TotalBytes = InstanceBytes + PropertyBytes + ResourceBytes;
+
+	UE_LOG(LogTemp, Display, TEXT("  %-32s %-36s %10llu %10llu %10llu"), TEXT("(actor)"), *ActorClass->GetName(),
+		(uint64)InstanceBytes, (uint64)PropertyBytes, (uint64)ResourceBytes);
+
+	TInlineComponentArray<UActorComponent*> Components(SampleActor);
+	for (UActorComponent* Component : Components)
+	{
+		MeasureObject(Component, InstanceBytes, PropertyBytes, ResourceBytes);
+		TotalBytes += InstanceBytes + PropertyBytes + ResourceBytes;
+
+		UE_LOG(LogTemp, Display, TEXT("  %-32s %-36s %10llu %10llu %10llu"), *Component->GetName(), *Component->GetClass()->GetName(),
+			(uint64)InstanceBytes, (uint64)PropertyBytes, (uint64)ResourceBytes);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("  Total per instance: %llu bytes across %d components"), (uint64)TotalBytes, Components.Num());
+
+	if (SpawnedActors.Num() > 1)
+	{
+		const uint64 GrowthBytes = UsedAfter > UsedBefore ? UsedAfter - UsedBefore : 0;
+		UE_LOG(LogTemp, Display, TEXT("  Process growth for %d instances: %llu bytes (%llu per instance)"),
+			SpawnedActors.Num(), GrowthBytes, GrowthBytes / SpawnedActors.Num());
+	}
+
+	for (AActor* Actor : SpawnedActors)
+	{
+		Actor->Destroy();
+	}
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FPSMissionStateComponent.h"
+#include "FPSGameState.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
+
+void FFPSMissionBitsItem::PostReplicatedAdd(const FFPSMissionBitsArray& InArraySerializer)
+{
+	if (InArraySerializer.OwnerComp)
+	{
+		InArraySerializer.OwnerComp->OnMissionStateChanged.Broadcast();
+	}
+}
+
+void FFPSMissionBitsItem::PostReplicatedChange(const FFPSMissionBitsArray& InArraySerializer)
+{
+	if (InArraySerializer.OwnerComp)
+	{
+		InArraySerializer.OwnerComp->OnMissionStateChanged.Broadcast();
+	}
+}
+
+void FFPSMissionBitsItem::PreReplicatedRemove(const FFPSMissionBitsArray& InArraySerializer)
+{
+	if (InArraySerializer.OwnerComp)
+	{
+		InArraySerializer.OwnerComp->OnMissionStateChanged.Broadcast();
+	}
+}
+
+UFPSMissionStateComponent::UFPSMissionStateComponent()
+{
+	// Everything happens in response to pickups & extractions, nothing to do every frame
+	PrimaryComponentTick.bCanEverTick = false;
+
+	SetIsReplicatedByDefault(true);
+
+	MissionBits.OwnerComp = this;
+}
+
+UFPSMissionStateComponent* UFPSMissionStateComponent::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const AFPSGameState* GS = World ? World->GetGameState<AFPSGameState>() : nullptr;
+	return GS ? GS->GetMissionStateComponent() : nullptr;
+}
+
+int32 UFPSMissionStateComponent::RegisterObjective(uint8 TeamId)
+{
+	// Counting it towards some team would make that team's mission impossible to finish
+	if (TeamId == InvalidTeamId)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Objective registered outside of any match, it doesn't count towards any mission"));
+		return INDEX_NONE;
+	}
+
+	int32& Count = NumObjectives.FindOrAdd(TeamId);
+	const int32 ObjectiveIndex = Count++;
+
+	SetBit(TeamId, EMissionBits::ObjectivesRequired, ObjectiveIndex);
+	RemainingObjectives.FindOrAdd(TeamId)++;
+
+	return ObjectiveIndex;
+}
+
+int32 UFPSMissionStateComponent::RegisterExtractionZone(uint8 TeamId)
+{
+	if (TeamId == InvalidTeamId)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Extraction zone registered outside of any match, it doesn't count towards any mission"));
+		return INDEX_NONE;
+	}
+
+	int32& Count = NumZones.FindOrAdd(TeamId);
+	const int32 ZoneIndex = Count++;
+
+	SetBit(TeamId, EMissionBits::ZonesAvailable, ZoneIndex);
+
+	return ZoneIndex;
+}
+
+void UFPSMissionStateComponent::ResetTeam(uint8 TeamId)
+{
+	const int32 NumRemoved = MissionBits.Items.RemoveAll([TeamId](const FFPSMissionBitsItem& Item) { return Item.TeamId == TeamId; });
+	if (NumRemoved > 0)
+	{
+		MissionBits.MarkArrayDirty();
+
+		// Removing items moved the others around
+		ItemLookup.Reset();
+		for (int32 ItemIndex = 0; ItemIndex < MissionBits.Items.Num(); ItemIndex++)
+		{
+			const FFPSMissionBitsItem& Item = MissionBits.Items[ItemIndex];
+			ItemLookup.Add(MakeKey(Item.TeamId, Item.Kind, Item.WordIndex), ItemIndex);
+		}
+	}
+
+	RemainingObjectives.Remove(TeamId);
+	NumObjectives.Remove(TeamId);
+	NumZones.Remove(TeamId);
+}
+
+void UFPSMissionStateComponent::NotifyObjectiveCollected(uint8 TeamId, int32 ObjectiveIndex)
+{
+	if (ObjectiveIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	SetBit(TeamId, EMissionBits::ObjectivesCollected, ObjectiveIndex);
+}
+
+bool UFPSMissionStateComponent::NotifyObjectivesExtracted(uint8 TeamId, int32 ZoneIndex, const TArray<int32>& ObjectiveIndices)
+{
+	if (ZoneIndex != INDEX_NONE)
+	{
+		SetBit(TeamId, EMissionBits::ZonesUsed, ZoneIndex);
+	}
+
+	int32* Remaining = RemainingObjectives.Find(TeamId);
+	if (Remaining == nullptr)
+	{
+		return false;
+	}
+
+	// Only count an objective the first time it's extracted, so the count can't go wrong if the same one comes in twice
+	bool bExtractedAny = false;
+	for (const int32 ObjectiveIndex : ObjectiveIndices)
+	{
+		if (ObjectiveIndex != INDEX_NONE
+			&& IsBitSet(TeamId, EMissionBits::ObjectivesRequired, ObjectiveIndex)
+			&& SetBit(TeamId, EMissionBits::ObjectivesExtracted, ObjectiveIndex))
+		{
+			(*Remaining)--;
+			bExtractedAny = true;
+		}
+	}
+
+	return bExtractedAny && *Remaining <= 0;
+}
+
+bool UFPSMissionStateComponent::IsBitSet(uint8 TeamId, EMissionBits Kind, int32 Index) const
+{
+	if (Index < 0)
+	{
+		return false;
+	}
+
+	const FFPSMissionBitsItem* Item = FindItem(TeamId, Kind, (uint16)(Index / 32));
+	return Item && (Item->Bits & (1u << (Index % 32))) != 0;
+}
+
+int32 UFPSMissionStateComponent::CountBits(uint8 TeamId, EMissionBits Kind) const
+{
+	int32 Count = 0;
+	for (const FFPSMissionBitsItem& Item : MissionBits.Items)
+	{
+		if (Item.TeamId == TeamId && Item.Kind == Kind)
+		{
+			Count += FMath::CountBits(Item.Bits);
+		}
+	}
+	return Count;
+}
+
+bool UFPSMissionStateComponent::SetBit(uint8 TeamId, EMissionBits Kind, int32 Index)
+{
+	// Every write goes through here, so nothing outside of a match ever ends up in a team's bits
+	if (TeamId == InvalidTeamId || Index < 0 || Index / 32 > MAX_uint16)
+	{
+		return false;
+	}
+
+	const uint16 WordIndex = (uint16)(Index / 32);
+	const uint32 Mask = 1u << (Index % 32);
+
+	FFPSMissionBitsItem* Item = nullptr;
+	if (const int32* ItemIndex = ItemLookup.Find(MakeKey(TeamId, Kind, WordIndex)))
+	{
+		Item = &MissionBits.Items[*ItemIndex];
+	}
+	else
+	{
+		const int32 NewItemIndex = MissionBits.Items.AddDefaulted();
+		ItemLookup.Add(MakeKey(TeamId, Kind, WordIndex), NewItemIndex);
+
+		Item = &MissionBits.Items[NewItemIndex];
+		Item->TeamId = TeamId;
+		Item->Kind = Kind;
+		Item->WordIndex = WordIndex;
+	}
+
+	if ((Item->Bits & Mask) != 0)
+	{
+		return false;
+	}
+
+	Item->Bits |= Mask;
+	MissionBits.MarkItemDirty(*Item);
+	return true;
+}
+
+const FFPSMissionBitsItem* UFPSMissionStateComponent::FindItem(uint8 TeamId, EMissionBits Kind, uint16 WordIndex) const
+{
+	// The server has the lookup, clients don't build one & just search the few items there are
+	if (const int32* ItemIndex = ItemLookup.Find(MakeKey(TeamId, Kind, WordIndex)))
+	{
+		return &MissionBits.Items[*ItemIndex];
+	}
+
+	return MissionBits.Items.FindByPredicate([TeamId, Kind, WordIndex](const FFPSMissionBitsItem& Item)
+	{
+		return Item.TeamId == TeamId && Item.Kind == Kind && Item.WordIndex == WordIndex;
+	});
+}
+
+void UFPSMissionStateComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UFPSMissionStateComponent, MissionBits);
+}
@@ -8,6 +8,8 @@ The references to sphere component in header file can be solved with forward dec
 #include "Components/SphereComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "FPSCharacter.h"
+#include "FPSGameMode.h"
+#include "FPSMissionStateComponent.h"
 
 // Sets default values
 AFPSObjectiveActor::AFPSObjectiveActor()
@@ -35,7 +37,17 @@ AFPSObjectiveActor::AFPSObjectiveActor()
 void AFPSObjectiveActor::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	if (HasAuthority())
+	{
+		AFPSGameMode* GM = Cast<AFPSGameMode>(GetWorld()->GetAuthGameMode());
+		UFPSMissionStateComponent* MissionState = UFPSMissionStateComponent::Get(this);
+		if (GM && MissionState)
+		{
+			TeamId = GM->GetMissionTeamId(this);
+			ObjectiveIndex = MissionState->RegisterObjective(TeamId);
+		}
+	}
 }
 
 void AFPSObjectiveActor::PlayEffect() 
@@ -55,6 +67,12 @@ void AFPSObjectiveActor::NotifyActorBeginOverlap(AActor* OtherActor)
 		if (Character)
 		{
 			Character->bIsCarryingObjective = true;
+			Character->CarriedObjectives.Add(ObjectiveIndex);
+
+			if (UFPSMissionStateComponent* MissionState = UFPSMissionStateComponent::Get(this))
+			{
+				MissionState->NotifyObjectiveCollected(TeamId, ObjectiveIndex);
+			}
 			Destroy();
 		}
 	}
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FPSPatrolPathSubsystem.h"
+#include "FPSPatrolRouteComponent.h"
+#include "NavigationSystem.h"
+#include "NavMesh/NavMeshPath.h"
+#include "GameFramework/Pawn.h"
+
+UFPSPatrolPathSubsystem::UFPSPatrolPathSubsystem()
+{
+	RepathInterval = 0.25f;
+	MaxRepathsPerBatch = 8;
+	TimeSinceLastBatch = 0.0f;
+}
+
+FNavPathSharedPtr UFPSPatrolPathSubsystem::FindOrBuildPath(AActor* FromWaypoint, AActor* ToWaypoint, const APawn* Querier)
+{
+	if (FromWaypoint == nullptr || ToWaypoint == nullptr || Querier == nullptr)
+	{
+		return nullptr;
+	}
+
+	const TPair<FObjectKey, FObjectKey> Key(FromWaypoint, ToWaypoint);
+	if (FNavPathSharedPtr* CachedPath = PathCache.Find(Key))
+	{
+		// A navmesh rebuild under the path marks it out of date, so we find it again rather than walk a stale one
+		if (CachedPath->IsValid() && (*CachedPath)->IsValid())
+		{
+			return CopyPath(*CachedPath);
+		}
+		PathCache.Remove(Key);
+	}
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ANavigationData* NavData = NavSys ? NavSys->GetNavDataForProps(Querier->GetNavAgentPropertiesRef()) : nullptr;
+	if (NavData == nullptr)
+	{
+		return nullptr;
+	}
+
+	/* This is the only synchronous query in the patrol code. It only runs the first time any guard walks this leg of a route,
+	* every guard after that gets the cached path. We don't pass the guard as the owner because the path isn't owned by one guard. */
+	FPathFindingQuery Query(this, *NavData, FromWaypoint->GetActorLocation(), ToWaypoint->GetActorLocation());
+	FPathFindingResult Result = NavSys->FindPathSync(Query);
+	if (!Result.IsSuccessful())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No patrol path found from %s to %s"), *FromWaypoint->GetName(), *ToWaypoint->GetName());
+		return nullptr;
+	}
+
+	PathCache.Add(Key, Result.Path);
+	return CopyPath(Result.Path);
+}
+
+FNavPathSharedPtr UFPSPatrolPathSubsystem::CopyPath(const FNavPathSharedPtr& CachedPath)
+{
+	TSharedRef<FNavMeshPath, ESPMode::ThreadSafe> PathCopy = MakeShared<FNavMeshPath, ESPMode::ThreadSafe>();
+	PathCopy->GetPathPoints() = CachedPath->GetPathPoints();
+	PathCopy->SetNavigationDataUsed(CachedPath->GetNavigationDataUsed());
+	PathCopy->SetIsPartial(CachedPath->IsPartial());
+	PathCopy->MarkReady();
+	return PathCopy;
+}
+
+void UFPSPatrolPathSubsystem::RequestRepath(UFPSPatrolRouteComponent* RouteComp, const FVector& Destination)
+{
+	if (RouteComp == nullptr)
+	{
+		return;
+	}
+
+	// A guard only ever needs its latest request, so replace any older one that hasn't been sent yet
+	CancelRepath(RouteComp);
+
+	FPendingRepath& Pending = PendingRepaths.AddDefaulted_GetRef();
+	Pending.RouteComp = RouteComp;
+	Pending.Destination = Destination;
+}
+
+void UFPSPatrolPathSubsystem::CancelRepath(UFPSPatrolRouteComponent* RouteComp)
+{
+	PendingRepaths.RemoveAll([RouteComp](const FPendingRepath& Pending) { return Pending.RouteComp == RouteComp; });
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	for (auto It = InFlightRepaths.CreateIterator(); It; ++It)
+	{
+		if (It.Value() == RouteComp)
+		{
+			if (NavSys)
+			{
+				NavSys->AbortAsyncFindPathRequest(It.Key());
+			}
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UFPSPatrolPathSubsystem::Deinitialize()
+{
+	PathCache.Empty();
+	PendingRepaths.Empty();
+	InFlightRepaths.Empty();
+
+	Super::Deinitialize();
+}
+
+void UFPSPatrolPathSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeSinceLastBatch += DeltaTime;
+	if (PendingRepaths.Num() == 0 || TimeSinceLastBatch < RepathInterval)
+	{
+		return;
+	}
+	TimeSinceLastBatch = 0.0f;
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (NavSys == nullptr)
+	{
+		return;
+	}
+
+	// Oldest requests go first, anything left over waits for the next batch
+	const int32 NumToSend = FMath::Min(PendingRepaths.Num(), MaxRepathsPerBatch);
+	TArray<FPendingRepath> Retries;
+	for (int32 Index = 0; Index < NumToSend; Index++)
+	{
+		const FPendingRepath& Pending = PendingRepaths[Index];
+		UFPSPatrolRouteComponent* RouteComp = Pending.RouteComp.Get();
+		if (RouteComp == nullptr)
+		{
+			continue;
+		}
+
+		/* The component waits for an answer & won't ask again on its own, so a request we can't send yet
+		* (no pawn possessed yet, navmesh not built yet) goes to the back of the queue instead of being dropped */
+		const APawn* Pawn = Cast<APawn>(RouteComp->GetOwner());
+		const ANavigationData* NavData = Pawn ? NavSys->GetNavDataForProps(Pawn->GetNavAgentPropertiesRef()) : nullptr;
+		if (NavData == nullptr)
+		{
+			Retries.Add(Pending);
+			continue;
+		}
+
+		const FNavAgentProperties& AgentProps = Pawn->GetNavAgentPropertiesRef();
+		FPathFindingQuery Query(Pawn, *NavData, Pawn->GetNavAgentLocation(), Pending.Destination);
+		const uint32 QueryID = NavSys->FindPathAsync(AgentProps, Query,
+			FNavPathQueryDelegate::CreateUObject(this, &UFPSPatrolPathSubsystem::OnRepathQueryFinished));
+		if (QueryID != INVALID_NAVQUERYID)
+		{
+			InFlightRepaths.Add(QueryID, Pending.RouteComp);
+		}
+		else
+		{
+			Retries.Add(Pending);
+		}
+	}
+	PendingRepaths.RemoveAt(0, NumToSend);
+	PendingRepaths.Append(Retries);
+}
+
+TStatId UFPSPatrolPathSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFPSPatrolPathSubsystem, STATGROUP_Tickables);
+}
+
+void UFPSPatrolPathSubsystem::OnRepathQueryFinished(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	TWeakObjectPtr<UFPSPatrolRouteComponent> RouteComp;
+	if (!InFlightRepaths.RemoveAndCopyValue(QueryID, RouteComp) || !RouteComp.IsValid())
+	{
+		return;
+	}
+
+	RouteComp->OnRepathFinished(Result == ENavigationQueryResult::Success ? Path : nullptr);
+}
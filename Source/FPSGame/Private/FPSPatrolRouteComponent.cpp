@@ -0,0 +1,159 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FPSPatrolRouteComponent.h"
+#include "FPSPatrolPathSubsystem.h"
+#include "AIController.h"
+#include "GameFramework/Pawn.h"
+
+// Sets default values for this component's properties
+UFPSPatrolRouteComponent::UFPSPatrolRouteComponent()
+{
+	// The AI controller's path following does the moving, we only react to its events so we never need to tick
+	PrimaryComponentTick.bCanEverTick = false;
+
+	AcceptanceRadius = 50.0f;
+	CurrentWaypointIndex = 0;
+	bPaused = true;
+}
+
+void UFPSPatrolRouteComponent::StartPatrol()
+{
+	// Like the rest of the AI code, movement is decided on the server & replicated to clients
+	if (!HasRoute() || !GetOwner()->HasAuthority())
+	{
+		return;
+	}
+
+	AAIController* AIC = GetAIController();
+	if (AIC == nullptr)
+	{
+		return;
+	}
+	AIC->ReceiveMoveCompleted.AddUniqueDynamic(this, &UFPSPatrolRouteComponent::OnMoveCompleted);
+
+	CurrentWaypointIndex = 0;
+	ResumePatrol();
+}
+
+void UFPSPatrolRouteComponent::PausePatrol()
+{
+	if (bPaused)
+	{
+		return;
+	}
+	bPaused = true;
+
+	if (UFPSPatrolPathSubsystem* PathSubsystem = GetWorld()->GetSubsystem<UFPSPatrolPathSubsystem>())
+	{
+		PathSubsystem->CancelRepath(this);
+	}
+
+	if (AAIController* AIC = GetAIController())
+	{
+		AIC->StopMovement();
+	}
+}
+
+void UFPSPatrolRouteComponent::ResumePatrol()
+{
+	if (!HasRoute() || !GetOwner()->HasAuthority())
+	{
+		return;
+	}
+	bPaused = false;
+
+	AActor* Waypoint = Waypoints[CurrentWaypointIndex];
+	UFPSPatrolPathSubsystem* PathSubsystem = GetWorld()->GetSubsystem<UFPSPatrolPathSubsystem>();
+	if (Waypoint && PathSubsystem)
+	{
+		PathSubsystem->RequestRepath(this, Waypoint->GetActorLocation());
+	}
+}
+
+void UFPSPatrolRouteComponent::OnRepathFinished(FNavPathSharedPtr Path)
+{
+	if (bPaused)
+	{
+		return;
+	}
+
+	if (!Path.IsValid())
+	{
+		// Try again with the next batch. The subsystem's rate limit keeps a bad waypoint from flooding the navmesh with queries.
+		ResumePatrol();
+		return;
+	}
+
+	FollowPath(Path);
+}
+
+void UFPSPatrolRouteComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		if (UFPSPatrolPathSubsystem* PathSubsystem = World->GetSubsystem<UFPSPatrolPathSubsystem>())
+		{
+			PathSubsystem->CancelRepath(this);
+		}
+	}
+
+	if (AAIController* AIC = GetAIController())
+	{
+		AIC->ReceiveMoveCompleted.RemoveDynamic(this, &UFPSPatrolRouteComponent::OnMoveCompleted);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UFPSPatrolRouteComponent::OnMoveCompleted(FAIRequestID RequestID, EPathFollowingResult::Type Result)
+{
+	// The controller broadcasts this for every move it makes, we only care about the ones we asked for
+	if (bPaused || RequestID != CurrentMoveRequestID)
+	{
+		return;
+	}
+
+	if (Result != EPathFollowingResult::Success)
+	{
+		// Blocked or the path was invalidated, find our way back to the route
+		ResumePatrol();
+		return;
+	}
+
+	const int32 ReachedIndex = CurrentWaypointIndex;
+	CurrentWaypointIndex = (CurrentWaypointIndex + 1) % Waypoints.Num();
+
+	UFPSPatrolPathSubsystem* PathSubsystem = GetWorld()->GetSubsystem<UFPSPatrolPathSubsystem>();
+	FNavPathSharedPtr Path = PathSubsystem ? PathSubsystem->FindOrBuildPath(Waypoints[ReachedIndex], Waypoints[CurrentWaypointIndex], Cast<APawn>(GetOwner())) : nullptr;
+	if (!Path.IsValid())
+	{
+		ResumePatrol();
+		return;
+	}
+
+	FollowPath(Path);
+}
+
+void UFPSPatrolRouteComponent::FollowPath(FNavPathSharedPtr Path)
+{
+	AAIController* AIC = GetAIController();
+	AActor* Waypoint = Waypoints[CurrentWaypointIndex];
+	if (AIC == nullptr || Waypoint == nullptr)
+	{
+		return;
+	}
+
+	FAIMoveRequest MoveRequest(Waypoint->GetActorLocation());
+	MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+	MoveRequest.SetUsePathfinding(true);
+
+	// We hand the path over instead of letting the controller find its own, that's what makes the cache pay off
+	CurrentMoveRequestID = AIC->RequestMove(MoveRequest, Path);
+}
+
+AAIController* UFPSPatrolRouteComponent::GetAIController() const
+{
+	const APawn* Pawn = Cast<APawn>(GetOwner());
+	return Pawn ? Cast<AAIController>(Pawn->GetController()) : nullptr;
+}
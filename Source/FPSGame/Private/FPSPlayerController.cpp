@@ -0,0 +1,195 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FPSPlayerController.h"
+#include "FPSGameMode.h"
+#include "Engine/LevelStreamingDynamic.h"
+#include "GameFramework/PlayerInput.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+
+AFPSPlayerController::AFPSPlayerController()
+{
+	RandomWalkStepDuration = 2.0f;
+	RandomFireRate = 0.5f;
+	MaxTurnPerSecond = 60.0f;
+	MaxLookUpPerSecond = 30.0f;
+
+	bIsBot = false;
+	BotScriptIndex = 0;
+	CurrentStepTimeLeft = 0.0f;
+	bFireHeld = false;
+
+	bMatchLevelLoaded = false;
+}
+
+void AFPSPlayerController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// The server has a copy of every player's controller, only the one on the bot's own machine drives the input
+	if (!IsLocalController() || !FParse::Param(FCommandLine::Get(), TEXT("FPSBot")))
+	{
+		return;
+	}
+	bIsBot = true;
+
+	// Many bots are usually started at once, so mix the process id in or they would all walk the same way
+	int32 Seed = 0;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("FPSBotSeed="), Seed))
+	{
+		Seed = (int32)FPlatformProcess::GetCurrentProcessId() ^ (int32)FPlatformTime::Cycles();
+	}
+	BotRandom.Initialize(Seed);
+
+	FString ScriptPath;
+	if (FParse::Value(FCommandLine::Get(), TEXT("FPSBotScript="), ScriptPath))
+	{
+		LoadBotScript(ScriptPath);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Running as load test bot, seed %d, %s"), Seed, BotScript.Num() > 0 ? *ScriptPath : TEXT("random walk"));
+}
+
+void AFPSPlayerController::PlayerTick(float DeltaTime)
+{
+	// Input is injected before the player input is processed in Super::PlayerTick, so it's handled this frame like a real key press
+	if (bIsBot && PlayerInput && GetPawn())
+	{
+		CurrentStepTimeLeft -= DeltaTime;
+		if (CurrentStepTimeLeft <= 0.0f)
+		{
+			NextBotStep();
+		}
+
+		// The axis mappings in DefaultInput.ini turn these into MoveForward, MoveRight, Turn & LookUp
+		InjectAxis(EKeys::Gamepad_LeftY, CurrentStep.Forward, DeltaTime);
+		InjectAxis(EKeys::Gamepad_LeftX, CurrentStep.Right, DeltaTime);
+		InjectAxis(EKeys::MouseX, CurrentStep.Turn * MaxTurnPerSecond * DeltaTime, DeltaTime);
+		// Positive MouseY is moving the mouse forward, so a positive LookUp in the script looks up
+		InjectAxis(EKeys::MouseY, CurrentStep.LookUp * MaxLookUpPerSecond * DeltaTime, DeltaTime);
+
+		// Fire is bound to IE_Pressed, so the trigger has to be let go before it can fire again
+		if (bFireHeld)
+		{
+			InjectFire(false);
+		}
+		else
+		{
+			const bool bWantsFire = BotScript.Num() > 0 ? CurrentStep.bFire : BotRandom.FRand() < RandomFireRate * DeltaTime;
+			if (bWantsFire)
+			{
+				InjectFire(true);
+			}
+		}
+	}
+
+	Super::PlayerTick(DeltaTime);
+}
+
+void AFPSPlayerController::ClientLoadMatchLevel_Implementation(const TSoftObjectPtr<UWorld>& Level, FVector Origin, const FString& LevelName)
+{
+	// A listen server's own player already has the server's copy
+	if (GetNetMode() != NM_Client)
+	{
+		return;
+	}
+
+	bool bSuccess = false;
+	ULevelStreamingDynamic* LevelStreaming = ULevelStreamingDynamic::LoadLevelInstanceBySoftObjectPtr(this, Level, Origin, FRotator::ZeroRotator, bSuccess, LevelName);
+	if (!bSuccess || LevelStreaming == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Couldn't load match level %s"), *Level.ToString());
+		return;
+	}
+
+	/* Once it's visible the engine tells the server on its own, which is what makes the server start replicating the guards
+	* & objectives in it to us. We tell the game mode as well so it knows it can spawn us now. */
+	LevelStreaming->OnLevelShown.AddDynamic(this, &AFPSPlayerController::OnMatchLevelShown);
+}
+
+void AFPSPlayerController::OnMatchLevelShown()
+{
+	ServerNotifyMatchLevelLoaded();
+}
+
+void AFPSPlayerController::ServerNotifyMatchLevelLoaded_Implementation()
+{
+	bMatchLevelLoaded = true;
+
+	if (AFPSGameMode* GM = GetWorld()->GetAuthGameMode<AFPSGameMode>())
+	{
+		GM->NotifyMatchLevelLoaded(this);
+	}
+}
+
+bool AFPSPlayerController::ServerNotifyMatchLevelLoaded_Validate()
+{
+	return true;
+}
+
+bool AFPSPlayerController::LoadBotScript(const FString& ScriptPath)
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *ScriptPath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Couldn't read bot script %s, falling back to random walk"), *ScriptPath);
+		return false;
+	}
+
+	for (const FString& Line : Lines)
+	{
+		TArray<FString> Fields;
+		Line.ParseIntoArray(Fields, TEXT(","));
+		if (Fields.Num() < 5 || Line.StartsWith(TEXT("#")))
+		{
+			continue;
+		}
+
+		const bool bHasLookUp = Fields.Num() >= 6;
+
+		FFPSBotScriptStep& Step = BotScript.AddDefaulted_GetRef();
+		Step.Duration = FMath::Max(0.01f, FCString::Atof(*Fields[0]));
+		Step.Forward = FMath::Clamp(FCString::Atof(*Fields[1]), -1.0f, 1.0f);
+		Step.Right = FMath::Clamp(FCString::Atof(*Fields[2]), -1.0f, 1.0f);
+		Step.Turn = FMath::Clamp(FCString::Atof(*Fields[3]), -1.0f, 1.0f);
+		Step.LookUp = bHasLookUp ? FMath::Clamp(FCString::Atof(*Fields[4]), -1.0f, 1.0f) : 0.0f;
+		Step.bFire = FCString::Atoi(*Fields[bHasLookUp ? 5 : 4]) != 0;
+	}
+
+	return BotScript.Num() > 0;
+}
+
+void AFPSPlayerController::NextBotStep()
+{
+	if (BotScript.Num() > 0)
+	{
+		// Scripts loop forever
+		CurrentStep = BotScript[BotScriptIndex];
+		BotScriptIndex = (BotScriptIndex + 1) % BotScript.Num();
+	}
+	else
+	{
+		CurrentStep.Duration = RandomWalkStepDuration * BotRandom.FRandRange(0.5f, 1.5f);
+		CurrentStep.Forward = BotRandom.FRandRange(-1.0f, 1.0f);
+		CurrentStep.Right = BotRandom.FRandRange(-1.0f, 1.0f);
+		CurrentStep.Turn = BotRandom.FRandRange(-1.0f, 1.0f);
+		CurrentStep.LookUp = BotRandom.FRandRange(-1.0f, 1.0f);
+		CurrentStep.bFire = false;
+	}
+
+	CurrentStepTimeLeft = CurrentStep.Duration;
+}
+
+void AFPSPlayerController::InjectAxis(const FKey& Key, float Value, float DeltaTime)
+{
+	InputKey(FInputKeyParams(Key, (double)Value, DeltaTime, 1, Key.IsGamepadKey()));
+}
+
+void AFPSPlayerController::InjectFire(bool bPressed)
+{
+	InputKey(FInputKeyParams(EKeys::Gamepad_RightTrigger, bPressed ? IE_Pressed : IE_Released, bPressed ? 1.0 : 0.0, true));
+	bFireHeld = bPressed;
+}
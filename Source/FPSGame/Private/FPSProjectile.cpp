@@ -3,6 +3,7 @@
 #include "FPSProjectile.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Components/SphereComponent.h"
+#include "FPSGameMode.h"
 
 AFPSProjectile::AFPSProjectile() 
 {
@@ -38,6 +39,39 @@ AFPSProjectile::AFPSProjectile()
 	Their movement */
 	SetReplicates(true);
 	SetReplicateMovement(true);
+
+	PathRelevancyRadius = 1500.0f;
+}
+
+bool AFPSProjectile::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	// The default check still decides first, so the net cull distance & everything else it looks at keep working
+	if (!Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation))
+	{
+		return false;
+	}
+
+	// The shooter's own connection & anything owning or viewing through it always get it
+	if (bAlwaysRelevant || IsOwnedBy(ViewTarget) || IsOwnedBy(RealViewer) || this == ViewTarget || ViewTarget == GetInstigator())
+	{
+		return true;
+	}
+
+	// Projectiles fired in another match on the same server are never relevant
+	const AFPSGameMode* GM = GetWorld()->GetAuthGameMode<AFPSGameMode>();
+	if (GM && !GM->AreInSameMatch(this, RealViewer))
+	{
+		return false;
+	}
+
+	/* On top of the default distance check, we check the segment the projectile will fly along until it dies.
+	* That way a player far off to the side never gets it, even when it's within the cull distance.
+	* A bounce changes the velocity, so the segment is rebuilt every time we're asked. */
+	const FVector Start = GetActorLocation();
+	const float RemainingLifeSpan = GetLifeSpan() > 0.0f ? GetLifeSpan() : InitialLifeSpan;
+	const FVector End = Start + GetVelocity() * RemainingLifeSpan;
+
+	return FMath::PointDistToSegmentSquared(SrcLocation, Start, End) <= FMath::Square(PathRelevancyRadius);
 }
 
 
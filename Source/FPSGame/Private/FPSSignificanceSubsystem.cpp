@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FPSSignificanceSubsystem.h"
+#include "SignificanceManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+
+void UFPSSignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UWorld* World = GetWorld();
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(World);
+	if (SignificanceManager == nullptr)
+	{
+		return;
+	}
+
+	// Clients only have their local player controllers, servers have one per connection
+	Viewpoints.Reset();
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC == nullptr)
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		Viewpoints.Emplace(ViewRotation, ViewLocation);
+	}
+
+	SignificanceManager->Update(Viewpoints);
+}
+
+TStatId UFPSSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFPSSignificanceSubsystem, STATGROUP_Tickables);
+}
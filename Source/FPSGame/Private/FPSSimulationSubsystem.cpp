@@ -0,0 +1,215 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FPSSimulationSubsystem.h"
+#include "FPSGuardConfig.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/UObjectIterator.h"
+
+bool UFPSSimulationSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer) || !FParse::Param(FCommandLine::Get(), TEXT("FPSSim")))
+	{
+		return false;
+	}
+
+	// The guards only think where they have authority, so there's nothing to simulate on a client
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && World->GetNetMode() != NM_Client;
+}
+
+void UFPSSimulationSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SimIndex = 0;
+	FParse::Value(FCommandLine::Get(), TEXT("FPSSimIndex="), SimIndex);
+
+	SimDuration = 600.0f;
+	FParse::Value(FCommandLine::Get(), TEXT("FPSSimDuration="), SimDuration);
+
+	float SimStep = 1.0f / 30.0f;
+	FParse::Value(FCommandLine::Get(), TEXT("FPSSimStep="), SimStep);
+
+	if (!FParse::Value(FCommandLine::Get(), TEXT("FPSSimOut="), OutputPath))
+	{
+		OutputPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Sim"), FString::Printf(TEXT("Sim_%d.csv"), SimIndex));
+	}
+
+	FString ParamsPath;
+	if (FParse::Value(FCommandLine::Get(), TEXT("FPSSimParams="), ParamsPath))
+	{
+		LoadParams(ParamsPath);
+	}
+
+	/* With a fixed timestep the engine advances game time by exactly SimStep every frame & doesn't wait for real time to catch up,
+	* so the run goes as fast as the CPU allows & the guards see the same frame times on any machine. */
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(FMath::Max(SimStep, 0.001f));
+
+	NumGuards = 0;
+	NumDetections = 0;
+	NumInvestigations = 0;
+	FirstDetectionTime = -1.0f;
+	NumFrames = 0;
+	WallStartTime = FPlatformTime::Seconds();
+	bFinished = false;
+}
+
+void UFPSSimulationSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// This runs before any actor's BeginPlay, so the guards copy the new values onto their sensing when they start
+	ApplyParams(GetMutableDefault<UFPSGuardConfig>());
+	for (TObjectIterator<UFPSGuardConfig> It; It; ++It)
+	{
+		ApplyParams(*It);
+	}
+
+	for (TActorIterator<AFPSAICharacter> It(&InWorld); It; ++It)
+	{
+		NumGuards++;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Simulation run %d started with %d guards, %d tuning values, stopping after %.0f seconds"), SimIndex, NumGuards, ParamNames.Num(), SimDuration);
+}
+
+void UFPSSimulationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	NumFrames++;
+	if (!bFinished && GetWorld()->GetTimeSeconds() >= SimDuration)
+	{
+		FinishRun(TEXT("Timeout"));
+	}
+}
+
+TStatId UFPSSimulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFPSSimulationSubsystem, STATGROUP_Tickables);
+}
+
+void UFPSSimulationSubsystem::NotifyGuardStateChanged(EAIState NewState)
+{
+	if (NewState == EAIState::Alerted)
+	{
+		NumDetections++;
+		if (FirstDetectionTime < 0.0f)
+		{
+			FirstDetectionTime = GetWorld()->GetTimeSeconds();
+		}
+	}
+	else if (NewState == EAIState::Suspicious)
+	{
+		NumInvestigations++;
+	}
+}
+
+void UFPSSimulationSubsystem::NotifyMissionComplete(bool bMissionSuccess)
+{
+	if (!bFinished)
+	{
+		FinishRun(bMissionSuccess ? TEXT("Success") : TEXT("Failure"));
+	}
+}
+
+bool UFPSSimulationSubsystem::LoadParams(const FString& ParamsPath)
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *ParamsPath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Couldn't read simulation parameters %s, running with the defaults"), *ParamsPath);
+		return false;
+	}
+
+	// Skip blank lines & comments so SimIndex always counts parameter rows
+	Lines.RemoveAll([](const FString& Line) { return Line.TrimStartAndEnd().IsEmpty() || Line.StartsWith(TEXT("#")); });
+	if (!Lines.IsValidIndex(SimIndex + 1))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s has no row %d, running with the defaults"), *ParamsPath, SimIndex);
+		return false;
+	}
+
+	Lines[0].ParseIntoArray(ParamNames, TEXT(","));
+	Lines[SimIndex + 1].ParseIntoArray(ParamValues, TEXT(","));
+	if (ParamNames.Num() != ParamValues.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Row %d of %s has %d values for %d columns, running with the defaults"), SimIndex, *ParamsPath, ParamValues.Num(), ParamNames.Num());
+		ParamNames.Reset();
+		ParamValues.Reset();
+		return false;
+	}
+
+	for (int32 ParamIndex = 0; ParamIndex < ParamNames.Num(); ParamIndex++)
+	{
+		ParamNames[ParamIndex].TrimStartAndEndInline();
+		ParamValues[ParamIndex].TrimStartAndEndInline();
+		if (FindFProperty<FProperty>(UFPSGuardConfig::StaticClass(), *ParamNames[ParamIndex]) == nullptr)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s isn't a property of UFPSGuardConfig, it's ignored"), *ParamNames[ParamIndex]);
+		}
+	}
+
+	return true;
+}
+
+void UFPSSimulationSubsystem::ApplyParams(UFPSGuardConfig* Config) const
+{
+	// Nobody looks at the debug spheres in a headless run, but a column can still turn them back on
+	Config->bDrawDebugSpheres = false;
+
+	for (int32 ParamIndex = 0; ParamIndex < ParamNames.Num(); ParamIndex++)
+	{
+		if (FProperty* Property = FindFProperty<FProperty>(UFPSGuardConfig::StaticClass(), *ParamNames[ParamIndex]))
+		{
+			Property->ImportText(*ParamValues[ParamIndex], Property->ContainerPtrToValuePtr<void>(Config), PPF_None, Config);
+		}
+	}
+}
+
+void UFPSSimulationSubsystem::FinishRun(const TCHAR* Outcome)
+{
+	bFinished = true;
+
+	const float SimSeconds = GetWorld()->GetTimeSeconds();
+	const double WallSeconds = FPlatformTime::Seconds() - WallStartTime;
+	const float SimMinutes = FMath::Max(SimSeconds / 60.0f, KINDA_SMALL_NUMBER);
+
+	// The tuning values go first so rows from many runs can be concatenated & compared directly
+	FString Header = TEXT("Index");
+	FString Row = FString::FromInt(SimIndex);
+	for (int32 ParamIndex = 0; ParamIndex < ParamNames.Num(); ParamIndex++)
+	{
+		Header += TEXT(",") + ParamNames[ParamIndex];
+		Row += TEXT(",") + ParamValues[ParamIndex];
+	}
+	Header += TEXT(",Outcome,SimSeconds,WallSeconds,Speedup,Frames,Guards,Detections,DetectionsPerMinute,Investigations,InvestigationsPerMinute,FirstDetectionTime\n");
+	Row += FString::Printf(TEXT(",%s,%.2f,%.2f,%.1f,%lld,%d,%d,%.3f,%d,%.3f,%.2f\n"),
+		Outcome,
+		SimSeconds,
+		WallSeconds,
+		WallSeconds > 0.0 ? SimSeconds / WallSeconds : 0.0,
+		NumFrames,
+		NumGuards,
+		NumDetections,
+		NumDetections / SimMinutes,
+		NumInvestigations,
+		NumInvestigations / SimMinutes,
+		FirstDetectionTime);
+
+	// Every run has its own file, so parallel runs never write to the same one
+	FFileHelper::SaveStringToFile(Header + Row, *OutputPath);
+
+	UE_LOG(LogTemp, Log, TEXT("Simulation run %d ended with %s after %.1f game seconds in %.1f real seconds, written to %s"), SimIndex, Outcome, SimSeconds, WallSeconds, *OutputPath);
+
+	FPlatformMisc::RequestExit(false);
+}
@@ -7,6 +7,8 @@
 #include "FPSAICharacter.generated.h"
 
 class UPawnSensingComponent;
+class UFPSPatrolRouteComponent;
+class UFPSGuardConfig;
 
 // We give BlueprintType to it so that we can use it in BP. It is because it's BlueprintType that we use uint8 else we could've used anything, even could have just used enum AICharState{}
 UENUM(BlueprintType)
@@ -17,6 +19,16 @@ enum class EAIState : uint8
 	Alerted
 };
 
+/* How much detail a guard gets, from its significance to the players. The values are the significance floats
+* handed to the significance manager, so higher means more important. */
+UENUM()
+enum class EGuardSignificance : uint8
+{
+	Minimal,
+	Reduced,
+	Full
+};
+
 UCLASS()
 class FPSGAME_API AFPSAICharacter : public ACharacter
 {
@@ -30,9 +42,47 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UPROPERTY(VisibleAnywhere, Category = "Components")
 		UPawnSensingComponent* PawnSensingComp;
 
+	/* Guards without waypoints stand still like before, guards with a route walk it whenever they are Idle.
+	* Null once play has started on clients, & on the server for guards without a route. */
+	UPROPERTY(VisibleAnywhere, Category = "Components")
+		UFPSPatrolRouteComponent* PatrolRouteComp;
+
+	bool HasPatrolRoute() const;
+
+	/* Perception & debug settings are the same for every guard of a kind, so they're edited once in a shared data asset.
+	* This doesn't make a server guard smaller: the sensing values are still copied onto each guard's PawnSensingComp,
+	* which only reads its own members, & this pointer comes on top. The per guard savings are the components freed in BeginPlay. */
+	UPROPERTY(EditAnywhere, Category = "AI")
+		UFPSGuardConfig* GuardConfig;
+
+	// Copies the perception settings from GuardConfig onto PawnSensingComp
+	void ApplyGuardConfig();
+
+	// Called by the significance manager once per viewpoint, the highest result is kept
+	float CalculateSignificance(const FTransform& Viewpoint) const;
+
+	// Scales the cost of the mesh & movement component to match the given level of detail
+	void ApplySignificance(EGuardSignificance Significance);
+
+	// Unset until the first ApplySignificance, so the first one always goes through
+	TOptional<EGuardSignificance> AppliedSignificance;
+
+	// Picks the update frequency & dormancy for a state. Has to run before the state changes so a dormant guard is woken up first.
+	void UpdateNetSettings(EAIState NewState);
+
+	// Run on a timer on the server. Wakes the guard up & raises its update rate while a player is inside its vision cone.
+	void UpdateFacingPlayer();
+
+	bool IsFacingAnyPlayer() const;
+
+	bool bFacingPlayer;
+	FTimerHandle TimerHandle_FacingCheck;
+
 	// Has to have UFunction() as it's the only way UE knows it's this function that is to binded with pawn sensing's on see pawn add dynamic
 	UFUNCTION()
 		void OnSeenPawn(APawn* SeenPawn);
@@ -46,6 +96,9 @@ protected:
 	UFUNCTION()
 		void OnNoiseHeard(APawn* NoiseInstigator, const FVector& Location, float Volume);
 
+	// Turns the guard towards Location & makes it Suspicious for a while. Used for noises & for alerts from other guards.
+	void InvestigateLocation(const FVector& Location);
+
 	/*Note on AIPerception-
 	Sight is given precedense over sound. When the character sees you it will no longer hear you.
 	This can be verified by looking at the debug spheres. Once it sees the player the sight debug spheres will be drawn but the sound debug spheres wont.
@@ -83,6 +136,19 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	// Returns GuardConfig, or the class defaults if no asset was assigned. Never null.
+	const UFPSGuardConfig* GetGuardConfig() const;
+
+	// Server only. Called by UFPSAlertSubsystem when another guard has seen an intruder at Location.
+	void ReceiveAlert(const FVector& Location);
+
+	/* Alerted guards are relevant to everyone. Idle guards far away are only relevant if there's nothing in between.
+	* Everything else falls back to the default distance check. */
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
+	// Alerted guards & guards looking at the viewer are sent first when bandwidth runs out
+	virtual float GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth) override;
+
 	// Don't need this as it will never take input
 	//virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FPSAlertSubsystem.generated.h"
+
+class AFPSAICharacter;
+
+/* Passes alerts from guard to guard without every guard talking to every other guard.
+* Guards are put in a grid, & the guards sharing a cell form a squad with one leader.
+* An alert goes to the leader of the alerting guard's squad, the leader tells its squad,
+* & then relays it to at most MaxRelayFanOut leaders of nearby squads, which do the same next frame, up to MaxHops times.
+* Alerts are queued & handled in one batch per frame, so the cost depends on the number of alerts, not guards². Server only. */
+UCLASS(Config = Game)
+class FPSGAME_API UFPSAlertSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UFPSAlertSubsystem();
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterGuard(AFPSAICharacter* Guard);
+	void UnregisterGuard(AFPSAICharacter* Guard);
+
+	// Queues an alert about Location, raised by Source. It's spread on the next tick.
+	void RaiseAlert(AFPSAICharacter* Source, const FVector& Location);
+
+protected:
+	// Size of a squad's grid cell
+	UPROPERTY(Config)
+		float SquadCellSize;
+
+	// Guards move, so squads are rebuilt this often
+	UPROPERTY(Config)
+		float SquadRebuildInterval;
+
+	// Squad members further than this from their leader don't hear the leader's alert
+	UPROPERTY(Config)
+		float SquadAlertRadius;
+
+	// How far a leader can relay an alert to other leaders
+	UPROPERTY(Config)
+		float LeaderRelayRadius;
+
+	// Max number of other leaders a leader relays a single alert to
+	UPROPERTY(Config)
+		int32 MaxRelayFanOut;
+
+	// How many times an alert can be relayed from leader to leader
+	UPROPERTY(Config)
+		int32 MaxHops;
+
+	// A leader that just passed on an alert ignores new ones for this long
+	UPROPERTY(Config)
+		float LeaderAlertCooldown;
+
+	// Alerts left over are handled on the next frame
+	UPROPERTY(Config)
+		int32 MaxAlertsPerFrame;
+
+	struct FSquad
+	{
+		TArray<AFPSAICharacter*> Members;
+		AFPSAICharacter* Leader = nullptr;
+	};
+
+	struct FPendingAlert
+	{
+		TWeakObjectPtr<AFPSAICharacter> Source;
+		FVector Location;
+		int32 HopsLeft;
+	};
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	void RebuildSquads();
+
+	// Tells the squad in Cell about the alert & queues the relays to nearby leaders
+	void SpreadAlert(const FPendingAlert& Alert, const FIntPoint& Cell, TSet<AFPSAICharacter*>& AlertedThisFrame);
+
+	TArray<TWeakObjectPtr<AFPSAICharacter>> Guards;
+
+	TMap<FIntPoint, FSquad> Squads;
+
+	// Which squad each guard was put in on the last rebuild, so an alerting guard finds its leader without searching
+	TMap<AFPSAICharacter*, FIntPoint> CellOfGuard;
+
+	TMap<TWeakObjectPtr<AFPSAICharacter>, float> LastRelayTime;
+
+	TArray<FPendingAlert> PendingAlerts;
+
+	float TimeSinceSquadRebuild;
+	bool bSquadsDirty;
+};
@@ -53,6 +53,11 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = "Gameplay")
 	UAnimSequence* FireAnimation;
 
+	/* Where the muzzle is relative to the eyes, in aim space, if it can't be worked out from the gun mesh's "Muzzle" socket.
+	* A dedicated server doesn't pose the gun so ServerFire uses the offset from GetMuzzleOffset() there. */
+	UPROPERTY(EditDefaultsOnly, Category = "Projectile")
+	FVector MuzzleOffset;
+
 protected:
 	
 	/** Fires a projectile. */
@@ -71,17 +76,36 @@ protected:
 
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
 
+	virtual void PreRegisterAllComponents() override;
+	virtual void BeginPlay() override;
+
+	// Muzzle location & rotation from the gun socket if the gun is posed, otherwise from GetMuzzleOffset()
+	void GetMuzzleTransform(FVector& OutLocation, FRotator& OutRotation) const;
+
+	// The "Muzzle" socket relative to the camera in the meshes' reference pose, computed once per class & cached on its default object
+	FVector GetMuzzleOffset() const;
+
+	bool ComputeMuzzleOffset(FVector& OutOffset) const;
+
+	// Only set on the class default object
+	bool bMuzzleOffsetCached;
+	FVector CachedMuzzleOffset;
+
 public:
-	/** Returns Mesh1P subobject **/
+	/** Returns Mesh1P subobject. Never registered on dedicated servers. **/
 	USkeletalMeshComponent* GetMesh1P() const { return Mesh1PComponent; }
 
-	/** Returns FirstPersonCameraComponent subobject **/
+	/** Returns FirstPersonCameraComponent subobject. Never registered on dedicated servers. **/
 	UCameraComponent* GetFirstPersonCameraComponent() const { return CameraComponent; }
 
 	// We want to access this from objective actor so it's public
-	UPROPERTY(BlueprintReadOnly, Category="Gameplay")
+	/* Replicated to the owning player only, for their UI. The full mission state of every team is in UFPSMissionStateComponent */
+	UPROPERTY(Replicated, BlueprintReadOnly, Category="Gameplay")
 		bool bIsCarryingObjective = false;
 
+	// Server only. Indices of the objectives this character picked up & hasn't extracted yet.
+	TArray<int32> CarriedObjectives;
+
 	virtual void Tick(float DeltaTime) override;
 };
 
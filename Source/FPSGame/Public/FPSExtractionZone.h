@@ -19,6 +19,7 @@ public:
 	AFPSExtractionZone();
 
 protected:
+	virtual void BeginPlay() override;
 
 	UPROPERTY(VisibleAnywhere, Category = "Components")
 		UBoxComponent* OverlapComp;
@@ -30,4 +31,8 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Sound")
 		USoundBase* ObjectiveMissingSound;
 
+	// Server only. Set when the zone registers with the mission state in BeginPlay.
+	int32 ZoneIndex = INDEX_NONE;
+	uint8 TeamId = 0;
+
 };
@@ -6,6 +6,38 @@
 #include "GameFramework/GameModeBase.h"
 #include "FPSGameMode.generated.h"
 
+class ULevelStreamingDynamic;
+
+/* One stealth match running inside a shared server process.
+* Each match is its own streamed in copy of the match level with its own guards, objectives & players.
+* The copies share every asset they reference (meshes, BP classes, textures), those are only loaded once per process. */
+USTRUCT()
+struct FFPSMatchInstance
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		ULevelStreamingDynamic* LevelStreaming = nullptr;
+
+	UPROPERTY()
+		TArray<AController*> Players;
+
+	/* Players that joined before the level was visible on the server & on their own machine.
+	* They are started once it's visible on both. */
+	UPROPERTY()
+		TArray<APlayerController*> PendingPlayers;
+
+	int32 MatchId = INDEX_NONE;
+
+	// Where the copy was placed & the name it was loaded with. Clients load their copy with the same values.
+	FVector Origin = FVector::ZeroVector;
+	FString LevelName;
+
+	bool bMissionComplete = false;
+
+	bool IsInUse() const { return LevelStreaming != nullptr; }
+};
+
 UCLASS()
 class AFPSGameMode : public AGameModeBase
 {
@@ -22,7 +54,72 @@ public:
 	UFUNCTION(BlueprintImplementableEvent)
 		void OnMissionCompleted(APawn* InstigatorPawn, bool bMissionSuccess);
 
+	/* Which match an actor belongs to. Actors in a match level belong to that match, players & their pawns to the match they were put in,
+	* & anything else to whatever its instigator belongs to. INDEX_NONE if we aren't hosting matches or the actor isn't part of one. */
+	int32 GetMatchIdForActor(const AActor* Actor) const;
+
+	// True unless both actors are part of different matches
+	bool AreInSameMatch(const AActor* A, const AActor* B) const;
+
+	bool IsHostingMatchInstances() const { return !MatchLevel.IsNull(); }
+
+	/* The team an actor's objectives & extractions count towards. Every match is one team, a single match server only has team 0.
+	* UFPSMissionStateComponent::InvalidTeamId when we're hosting matches & the actor isn't part of one. */
+	uint8 GetMissionTeamId(const AActor* Actor) const;
+
+	// Called by AFPSPlayerController once the player's machine has its copy of the match level visible
+	void NotifyMatchLevelLoaded(APlayerController* PC);
+
 protected:
+	/* Leave this empty for the usual one match per server. When it's set, the server map should be an empty host map
+	* & every match gets its own copy of this level, placed MatchInstanceSpacing apart so they never see or hear each other.
+	* A navmesh built in the editor stays where it was built, it doesn't move with a copy that's loaded at an offset.
+	* So the navmesh is generated at runtime instead (RuntimeGeneration=Dynamic in DefaultEngine.ini): the host map needs a
+	* RecastNavMesh of its own, & the NavMeshBoundsVolumes in each copy of this level add their area to it as the copy streams in. */
+	UPROPERTY(EditDefaultsOnly, Category = "Match Instances")
+		TSoftObjectPtr<UWorld> MatchLevel;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Match Instances")
+		int32 MaxPlayersPerMatch;
+
+	// The match id is the mission team id, so it has to stay below UFPSMissionStateComponent::InvalidTeamId
+	UPROPERTY(EditDefaultsOnly, Category = "Match Instances", meta = (ClampMin = "1", ClampMax = "255"))
+		int32 MaxMatchInstances;
+
+	// MaxMatchInstances, limited to the number of team ids there are
+	int32 GetMaxMatchInstances() const;
+
+	// Must be well beyond the guards' sight radius & hearing range, & the net cull distance
+	UPROPERTY(EditDefaultsOnly, Category = "Match Instances")
+		float MatchInstanceSpacing;
+
+	// Slot index is the match id. Slots are reused once every player in a match has left.
+	UPROPERTY(Transient)
+		TArray<FFPSMatchInstance> MatchInstances;
+
+	// Only used to give each streamed level a unique package name, even when a slot is reused
+	int32 NumMatchesCreated;
+
+	// Turns players away while every match is full, so they get told why instead of joining & never spawning
+	virtual void PreLogin(const FString& Options, const FString& Address, const FUniqueNetIdRepl& UniqueId, FString& ErrorMessage) override;
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+	virtual AActor* ChoosePlayerStart_Implementation(AController* Player) override;
+	virtual bool ShouldSpawnAtStartSpot_Implementation(AController* Player) override;
+	virtual void ReplicateStreamingStatus(APlayerController* PC) override;
+	virtual void Logout(AController* Exiting) override;
+
+	// True if a new player would get a match, either one that still has room or a free slot for a new one
+	bool HasRoomForNewPlayer() const;
+
+	FFPSMatchInstance* FindMatchForController(const AController* Controller);
+	FFPSMatchInstance* FindOrCreateMatchForPlayer(APlayerController* NewPlayer);
+
+	UFUNCTION()
+		void OnMatchLevelShown();
+
+	// Starts the waiting players of a match whose level is visible both on the server & on their machine
+	void StartPendingPlayers(FFPSMatchInstance& Match);
+
 	// Spectating viewpoint class is a BP class so we need some way of refering to it inside C++ code so we create TSubclassOf variable & will later set it to the BP class name
 	UPROPERTY(EditDefaultsOnly, Category = "Spectating")
 		TSubclassOf<AActor> SpectatingViewpointClass;
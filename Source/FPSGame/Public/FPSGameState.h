@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameStateBase.h"
+#include "FPSGameState.generated.h"
+
+class UFPSMissionStateComponent;
+
+/* The game mode only exists on the server, the game state exists everywhere.
+* So anything about the mission that clients need to know, e.g. for the objective UI, lives here. */
+UCLASS()
+class FPSGAME_API AFPSGameState : public AGameStateBase
+{
+	GENERATED_BODY()
+
+public:
+	AFPSGameState();
+
+	UFPSMissionStateComponent* GetMissionStateComponent() const { return MissionStateComp; }
+
+protected:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+		UFPSMissionStateComponent* MissionStateComp;
+};
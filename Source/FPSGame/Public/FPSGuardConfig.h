@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "FPSGuardConfig.generated.h"
+
+/* Tuning that every guard of a kind has in common, so it's edited in one place instead of on every placed guard.
+* The perception values are copied onto each guard's PawnSensingComp when it starts playing, the rest is read from here.
+* Guards without an asset use the defaults below & keep whatever perception settings their PawnSensingComp has. */
+UCLASS(BlueprintType)
+class FPSGAME_API UFPSGuardConfig : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UFPSGuardConfig();
+
+	// Perception. These are copied onto the guard's PawnSensingComp when it starts playing.
+	UPROPERTY(EditDefaultsOnly, Category = "Perception")
+		float SightRadius;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Perception")
+		float PeripheralVisionAngle;
+
+	// Max distance a noise can be heard from when the guard can't see where it came from
+	UPROPERTY(EditDefaultsOnly, Category = "Perception")
+		float HearingThreshold;
+
+	// Max distance a noise can be heard from when the guard can see where it came from
+	UPROPERTY(EditDefaultsOnly, Category = "Perception")
+		float LOSHearingThreshold;
+
+	// Seconds between two perception updates
+	UPROPERTY(EditDefaultsOnly, Category = "Perception")
+		float SensingInterval;
+
+	// How long a guard looks at a noise before it goes back to Idle
+	UPROPERTY(EditDefaultsOnly, Category = "Perception")
+		float ResetOrientationDelay;
+
+	/* Significance. Idle guards far away or outside every player's view animate & move at a lower rate.
+	* Suspicious & Alerted guards always run at full rate. */
+	UPROPERTY(EditDefaultsOnly, Category = "Significance")
+		bool bScaleBySignificance;
+
+	// Guards closer than this to any player run at full rate, even when they are behind the player
+	UPROPERTY(EditDefaultsOnly, Category = "Significance")
+		float FullDetailDistance;
+
+	// Guards in view & closer than this run at full rate. Out of view but closer than this, they run at reduced rate.
+	UPROPERTY(EditDefaultsOnly, Category = "Significance")
+		float ReducedDetailDistance;
+
+	// Half angle of the cone in front of a player that counts as "in view"
+	UPROPERTY(EditDefaultsOnly, Category = "Significance")
+		float ViewConeHalfAngle;
+
+	// Seconds between animation & movement updates at reduced & minimal detail
+	UPROPERTY(EditDefaultsOnly, Category = "Significance")
+		float ReducedTickInterval;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Significance")
+		float MinimalTickInterval;
+
+	/* Replication. Guards that matter to the players replicate often, quiet guards rarely,
+	* & guards that stand still without a route go dormant until something happens to them. */
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+		float AlertedNetUpdateFrequency;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+		float SuspiciousNetUpdateFrequency;
+
+	// Guards with a player inside their vision cone, whatever state they're in. A guard that could catch the player has to look right.
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+		float FacingNetUpdateFrequency;
+
+	// Seconds between two checks for players inside a guard's vision cone
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+		float FacingCheckInterval;
+
+	// Idle guards walking a patrol route
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+		float PatrolNetUpdateFrequency;
+
+	// Idle guards standing still
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+		float IdleNetUpdateFrequency;
+
+	// Idle guards further than this from a player are only relevant to that player if nothing blocks the view between them
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+		float OccludedCullDistance;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+		float AlertedNetPriorityScale;
+
+	// Applied when the player is inside the guard's vision cone
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+		float FacingNetPriorityScale;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Debug")
+		bool bDrawDebugSpheres;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Debug")
+		float DebugSphereDuration;
+};
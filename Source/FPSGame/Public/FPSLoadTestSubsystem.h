@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FPSLoadTestSubsystem.generated.h"
+
+/* Only exists on a server started with -FPSLoadTest.
+* Every few seconds it appends one row to Saved/LoadTest/LoadTest_<time>.csv with the server tick time,
+* the bandwidth & packet rates per connection, & how often ServerFire was validated & run.
+* -FPSLoadTestInterval=<seconds> changes how often a row is written (default 5). */
+UCLASS()
+class FPSGAME_API UFPSLoadTestSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Called from AFPSCharacter's ServerFire RPC
+	void CountServerFireValidate() { NumServerFireValidates++; }
+	void CountServerFire() { NumServerFires++; }
+
+protected:
+	void WriteReport();
+
+	FString ReportPath;
+	float ReportInterval;
+	float TimeSinceReport;
+
+	// Game thread times since the last report, in seconds
+	double TickTimeSum;
+	double TickTimeMax;
+	int32 NumTicks;
+
+	int32 NumServerFireValidates;
+	int32 NumServerFires;
+};
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "FPSMemoryReportCommandlet.generated.h"
+
+/* Spawns each gameplay class in an empty world without rendering & logs how much memory one instance costs,
+* split into the actor & each of its components.
+* Run with: UnrealEditor-Cmd FPSGame.uproject -run=FPSMemoryReport [-Count=1000] [-Classes=/Game/Blueprints/BP_AICharacter.BP_AICharacter_C,...]
+* -Count spawns that many of each class & also reports the process memory growth divided by the count,
+* which includes allocations the per object numbers can't see (physics bodies, anim instances etc). */
+UCLASS()
+class UFPSMemoryReportCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UFPSMemoryReportCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+	// Size of the object itself, plus what its properties allocate (arrays, strings etc.), plus its exclusive resources
+	static void MeasureObject(UObject* Object, SIZE_T& OutInstanceBytes, SIZE_T& OutPropertyBytes, SIZE_T& OutResourceBytes);
+
+	void ReportClass(UWorld* World, UClass* ActorClass, int32 Count);
+};
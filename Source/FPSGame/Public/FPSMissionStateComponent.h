@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "FPSMissionStateComponent.generated.h"
+
+class UFPSMissionStateComponent;
+
+// What a set of mission bits means. Bit N is objective (or zone) N of the team.
+UENUM(BlueprintType)
+enum class EMissionBits : uint8
+{
+	ObjectivesRequired,
+	ObjectivesCollected,
+	ObjectivesExtracted,
+	ZonesAvailable,
+	ZonesUsed
+};
+
+/* 32 bits of one kind for one team. The mission state is split into these small words so that
+* picking up one objective only sends the one word that changed, not the whole mission. */
+USTRUCT()
+struct FFPSMissionBitsItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		uint8 TeamId = 0;
+
+	UPROPERTY()
+		EMissionBits Kind = EMissionBits::ObjectivesRequired;
+
+	UPROPERTY()
+		uint16 WordIndex = 0;
+
+	UPROPERTY()
+		uint32 Bits = 0;
+
+	void PostReplicatedAdd(const struct FFPSMissionBitsArray& InArraySerializer);
+	void PostReplicatedChange(const struct FFPSMissionBitsArray& InArraySerializer);
+	void PreReplicatedRemove(const struct FFPSMissionBitsArray& InArraySerializer);
+};
+
+USTRUCT()
+struct FFPSMissionBitsArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		TArray<FFPSMissionBitsItem> Items;
+
+	// Lets the items tell the component that something changed on clients
+	UFPSMissionStateComponent* OwnerComp = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FFPSMissionBitsItem, FFPSMissionBitsArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FFPSMissionBitsArray> : public TStructOpsTypeTraitsBase2<FFPSMissionBitsArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnMissionStateChanged);
+
+/* Tracks every objective & extraction zone of every team as bitsets.
+* Objectives & zones register themselves when they begin play, pickups & extractions set single bits,
+* & completion is kept as a running count per team so we never have to go looking through actors.
+* Lives on AFPSGameState so that every client gets it. */
+UCLASS(ClassGroup = (Gameplay), meta = (BlueprintSpawnableComponent))
+class FPSGAME_API UFPSMissionStateComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UFPSMissionStateComponent();
+
+	/* Team of actors that aren't part of any match, e.g. an objective left in the host map of a server hosting several matches.
+	* It's the top of the range so every lower value can be a match. Anything written for it is ignored. */
+	static constexpr uint8 InvalidTeamId = MAX_uint8;
+
+	// Returns the mission state of the world's game state, or null if the game mode doesn't use AFPSGameState
+	static UFPSMissionStateComponent* Get(const UObject* WorldContextObject);
+
+	// Server only. Returns the index the objective has within its team, INDEX_NONE for InvalidTeamId.
+	int32 RegisterObjective(uint8 TeamId);
+
+	// Server only. Returns the index the zone has within its team, INDEX_NONE for InvalidTeamId.
+	int32 RegisterExtractionZone(uint8 TeamId);
+
+	// Server only. Forgets everything about a team, e.g. when a new match reuses its slot.
+	void ResetTeam(uint8 TeamId);
+
+	// Server only
+	void NotifyObjectiveCollected(uint8 TeamId, int32 ObjectiveIndex);
+
+	// Server only. Returns true when this extraction brought the last required objective of the team home.
+	bool NotifyObjectivesExtracted(uint8 TeamId, int32 ZoneIndex, const TArray<int32>& ObjectiveIndices);
+
+	UFUNCTION(BlueprintPure, Category = "Mission")
+		bool IsBitSet(uint8 TeamId, EMissionBits Kind, int32 Index) const;
+
+	UFUNCTION(BlueprintPure, Category = "Mission")
+		int32 CountBits(uint8 TeamId, EMissionBits Kind) const;
+
+	// Fired on clients whenever a replicated word changes, so UI doesn't have to poll
+	UPROPERTY(BlueprintAssignable, Category = "Mission")
+		FOnMissionStateChanged OnMissionStateChanged;
+
+protected:
+	UPROPERTY(Replicated)
+		FFPSMissionBitsArray MissionBits;
+
+	// Server only, so pickups don't have to search the items. Key is made by MakeKey().
+	TMap<uint32, int32> ItemLookup;
+
+	// Server only. Required objectives per team that haven't been extracted yet.
+	TMap<uint8, int32> RemainingObjectives;
+
+	TMap<uint8, int32> NumObjectives;
+	TMap<uint8, int32> NumZones;
+
+	static uint32 MakeKey(uint8 TeamId, EMissionBits Kind, uint16 WordIndex)
+	{
+		return ((uint32)TeamId << 24) | ((uint32)Kind << 16) | WordIndex;
+	}
+
+	// Sets one bit & marks only its word dirty. Returns false if it was already set.
+	bool SetBit(uint8 TeamId, EMissionBits Kind, int32 Index);
+
+	const FFPSMissionBitsItem* FindItem(uint8 TeamId, EMissionBits Kind, uint16 WordIndex) const;
+};
@@ -28,6 +28,10 @@ protected:
 		USphereComponent* SphereComp;
 
 	void PlayEffect(); // don't want anyone else to access this fn
+
+	// Server only. Set when the objective registers with the mission state in BeginPlay.
+	int32 ObjectiveIndex = INDEX_NONE;
+	uint8 TeamId = 0;
 	UPROPERTY(EditDefaultsOnly, Category = "FX")
 		UParticleSystem* EmitterFX;
 
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NavigationData.h"
+#include "UObject/ObjectKey.h"
+#include "FPSPatrolPathSubsystem.generated.h"
+
+class UFPSPatrolRouteComponent;
+
+/* Owns every navmesh path that guards use to patrol.
+* Paths between two waypoints are found once & cached by waypoint pair, so 20 guards on one route cost the same as 1.
+* Re-paths (from wherever a guard stopped back to its route) can't be cached, so they are queued
+* & sent to the navigation system as async queries, a few at a time, at most every RepathInterval seconds. */
+UCLASS(Config = Game)
+class FPSGAME_API UFPSPatrolPathSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UFPSPatrolPathSubsystem();
+
+	/* Returns a copy of the cached path from one waypoint to the next, finding it the first time it's asked for.
+	* Path following keeps its own state on the path it's given (observers, invalidation, repaths), so every move gets its own copy. */
+	FNavPathSharedPtr FindOrBuildPath(AActor* FromWaypoint, AActor* ToWaypoint, const APawn* Querier);
+
+	// Queues an async path from the route's pawn back to Destination. The component is called back when it's done.
+	void RequestRepath(UFPSPatrolRouteComponent* RouteComp, const FVector& Destination);
+
+	void CancelRepath(UFPSPatrolRouteComponent* RouteComp);
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	// Seconds between two batches of re-path queries
+	UPROPERTY(Config)
+		float RepathInterval;
+
+	// Max number of async re-path queries sent per batch
+	UPROPERTY(Config)
+		int32 MaxRepathsPerBatch;
+
+	// Only the points are shared between guards, the path object around them is new for every move
+	static FNavPathSharedPtr CopyPath(const FNavPathSharedPtr& CachedPath);
+
+	void OnRepathQueryFinished(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+	struct FPendingRepath
+	{
+		TWeakObjectPtr<UFPSPatrolRouteComponent> RouteComp;
+		FVector Destination;
+	};
+
+	TMap<TPair<FObjectKey, FObjectKey>, FNavPathSharedPtr> PathCache;
+
+	TArray<FPendingRepath> PendingRepaths;
+
+	// Async queries that have been sent but haven't come back yet
+	TMap<uint32, TWeakObjectPtr<UFPSPatrolRouteComponent>> InFlightRepaths;
+
+	float TimeSinceLastBatch;
+};
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "AITypes.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "NavigationData.h"
+#include "FPSPatrolRouteComponent.generated.h"
+
+class AAIController;
+
+/* Makes the owning guard walk a loop of waypoints.
+* The paths between waypoints aren't computed here, they are fetched from UFPSPatrolPathSubsystem
+* so that every guard walking the same route shares one copy of each path. */
+UCLASS(ClassGroup = (AI), meta = (BlueprintSpawnableComponent))
+class FPSGAME_API UFPSPatrolRouteComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UFPSPatrolRouteComponent();
+
+	/* Waypoints are usually target points placed in the level. Guards that reference the same waypoint actors
+	* in the same order share the cached paths between them. */
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Patrol")
+		TArray<AActor*> Waypoints;
+
+	// How close the guard has to get to a waypoint before it moves on to the next one
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Patrol")
+		float AcceptanceRadius;
+
+	bool HasRoute() const { return Waypoints.Num() >= 2; }
+
+	// Starts (or restarts) walking towards the current waypoint. Only does anything on the server.
+	void StartPatrol();
+
+	// Stops the guard where it is, e.g. while it investigates a noise
+	void PausePatrol();
+
+	/* Continues the patrol after a pause. The guard is no longer on a waypoint so a new path is needed,
+	* this is requested through the subsystem which rate-limits & batches these queries. */
+	void ResumePatrol();
+
+	// Called by UFPSPatrolPathSubsystem once the async re-path query has finished
+	void OnRepathFinished(FNavPathSharedPtr Path);
+
+protected:
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Bound to the AI controller's ReceiveMoveCompleted so we know when a waypoint was reached
+	UFUNCTION()
+		void OnMoveCompleted(FAIRequestID RequestID, EPathFollowingResult::Type Result);
+
+	void FollowPath(FNavPathSharedPtr Path);
+
+	AAIController* GetAIController() const;
+
+	int32 CurrentWaypointIndex;
+
+	bool bPaused;
+
+	FAIRequestID CurrentMoveRequestID;
+};
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "FPSPlayerController.generated.h"
+
+/* One step of a bot script. Each line of the script file is "Duration,Forward,Right,Turn,LookUp,Fire",
+* e.g. "2.0,1,0,0.5,-0.2,1" walks forward for 2 seconds while turning, looking down a little & firing.
+* Lines with 5 values are the older format without LookUp. */
+struct FFPSBotScriptStep
+{
+	float Duration = 1.0f;
+	float Forward = 0.0f;
+	float Right = 0.0f;
+	float Turn = 0.0f;
+	float LookUp = 0.0f;
+	bool bFire = false;
+};
+
+/* Normal player controller, except that a client started with -FPSBot plays by itself.
+* The bot doesn't call MoveForward, Fire etc. directly, it presses keys & moves sticks through the player input
+* so the server sees exactly the same movement & ServerFire traffic as from a real player.
+* Without -FPSBotScript=<file> it does a random walk. -FPSBotSeed=<n> makes the random walk repeatable. */
+UCLASS()
+class FPSGAME_API AFPSPlayerController : public APlayerController
+{
+	GENERATED_BODY()
+
+public:
+	AFPSPlayerController();
+
+	virtual void BeginPlay() override;
+	virtual void PlayerTick(float DeltaTime) override;
+
+	bool IsBot() const { return bIsBot; }
+
+	/* When the server hosts several matches, each client only streams in the copy of the match level its own match plays in.
+	* LevelName has to be the server's name for that copy, that's how the actors in it are matched up between server & client. */
+	UFUNCTION(Client, Reliable)
+		void ClientLoadMatchLevel(const TSoftObjectPtr<UWorld>& Level, FVector Origin, const FString& LevelName);
+
+	// Server side. True once this player's machine has its match level visible, so it's safe to spawn the player in it.
+	bool HasMatchLevelLoaded() const { return bMatchLevelLoaded || IsLocalController(); }
+
+protected:
+	// Seconds between picking a new random direction
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+		float RandomWalkStepDuration;
+
+	// Chance to fire per second
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+		float RandomFireRate;
+
+	// Mouse movement per second when turning at full rate
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+		float MaxTurnPerSecond;
+
+	// Mouse movement per second when looking up or down at full rate
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+		float MaxLookUpPerSecond;
+
+	UFUNCTION(Server, Reliable, WithValidation)
+		void ServerNotifyMatchLevelLoaded();
+
+	// Bound to the client's copy of the match level
+	UFUNCTION()
+		void OnMatchLevelShown();
+
+	bool bMatchLevelLoaded;
+
+	bool LoadBotScript(const FString& ScriptPath);
+
+	// Picks the next scripted step, or a random one if there's no script
+	void NextBotStep();
+
+	void InjectAxis(const FKey& Key, float Value, float DeltaTime);
+	void InjectFire(bool bPressed);
+
+	bool bIsBot;
+
+	TArray<FFPSBotScriptStep> BotScript;
+	int32 BotScriptIndex;
+
+	FFPSBotScriptStep CurrentStep;
+	float CurrentStepTimeLeft;
+
+	bool bFireHeld;
+
+	FRandomStream BotRandom;
+};
@@ -26,6 +26,10 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement")
 	UProjectileMovementComponent* ProjectileMovement;
 
+	/** Players further than this from the rest of the projectile's flight path don't get it replicated */
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+	float PathRelevancyRadius;
+
 public:
 
 	AFPSProjectile();
@@ -34,6 +38,10 @@ public:
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	/* Projectiles are small & short lived, a player only needs to know about one that passes near them.
+	 * Only narrows the default check, the shooter always gets theirs. */
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
 	/** Returns CollisionComp subobject **/
 	USphereComponent* GetCollisionComp() const { return CollisionComp; }
 
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FPSSignificanceSubsystem.generated.h"
+
+/* The significance manager doesn't know where the players are looking, someone has to hand it the viewpoints every frame.
+* On clients that's the local players. On a server it's every connected player, since the server
+* moves & animates guards for all of them. */
+UCLASS()
+class FPSGAME_API UFPSSignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	// Kept around so we don't allocate every frame
+	TArray<FTransform> Viewpoints;
+};
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FPSAICharacter.h"
+#include "FPSSimulationSubsystem.generated.h"
+
+/* Only exists in a game started with -FPSSim. Runs one stealth mission at a fixed timestep as fast as the CPU allows,
+* then writes one CSV row with how often the guards detected the player & how the mission ended, & quits.
+* Meant to be run headless (-nullrhi -nosound) with the player driven by the -FPSBot controller, many processes at once.
+* See Scripts/RunAISweep.sh.
+*
+* -FPSSimParams=<file> is a CSV whose header names UFPSGuardConfig properties, e.g. "HearingThreshold,ResetOrientationDelay".
+*   Row -FPSSimIndex=<n> (0 is the first row after the header) is written onto every guard config before the guards start.
+* -FPSSimDuration=<seconds> of game time before the run is stopped as a timeout (default 600).
+* -FPSSimStep=<seconds> is the fixed timestep (default 1/30).
+* -FPSSimOut=<file> is where the row goes (default Saved/Sim/Sim_<index>.csv). */
+UCLASS()
+class FPSGAME_API UFPSSimulationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// True when this run sets the given UFPSGuardConfig property, so guards without a config asset should use it too
+	bool IsSweepingProperty(FName PropertyName) const { return ParamNames.Contains(PropertyName.ToString()); }
+
+	// Called from AFPSAICharacter::ChangeGuardState
+	void NotifyGuardStateChanged(EAIState NewState);
+
+	// Called from AFPSGameMode::CompleteMission
+	void NotifyMissionComplete(bool bMissionSuccess);
+
+protected:
+	bool LoadParams(const FString& ParamsPath);
+	void ApplyParams(UFPSGuardConfig* Config) const;
+
+	void FinishRun(const TCHAR* Outcome);
+
+	int32 SimIndex;
+	float SimDuration;
+	FString OutputPath;
+
+	TArray<FString> ParamNames;
+	TArray<FString> ParamValues;
+
+	int32 NumGuards;
+	int32 NumDetections;
+	int32 NumInvestigations;
+	float FirstDetectionTime;
+
+	int64 NumFrames;
+	double WallStartTime;
+	bool bFinished;
+};